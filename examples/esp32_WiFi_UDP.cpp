@@ -22,5 +22,10 @@ void setup()
 }
 void loop()
 {
+    //reconnect after the WiFi was lost; the master may resume its session
+    if(!alup.connected)
+    {
+        alup.Connect(&connection, "Test", "Extra values");
+    }
     alup.Run();
 }
\ No newline at end of file
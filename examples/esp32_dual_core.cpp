@@ -0,0 +1,36 @@
+#include <Arduino.h>
+#include <FastLED.h>
+#include "ALUP/SerialConnection.h"
+#include "ALUP/ALUP.h"
+#include "ALUP/RenderPipeline.h"
+
+#define NUM_LEDS 1000
+#define DATA_PIN 13
+#define CLOCK_PIN 12
+
+//the frames are shown from one array while the next one is received into the other
+CRGB leds[NUM_LEDS];
+CRGB backLeds[NUM_LEDS];
+
+
+Alup alup(leds, NUM_LEDS, DATA_PIN, CLOCK_PIN);
+SerialConnection connection = SerialConnection(115200);
+RenderPipeline* pipeline;
+
+void setup()
+{
+    CLEDController& controller = FastLED.addLeds<WS2812B, DATA_PIN, GRB>(leds, NUM_LEDS);
+
+    //show the frames on core 0 while loop() receives on core 1
+    pipeline = new RenderPipeline(&controller, leds, backLeds, NUM_LEDS);
+    pipeline->Begin();
+    alup.UseRenderPipeline(pipeline);
+}
+void loop()
+{
+    if(!alup.connected)
+    {
+      alup.Connect(&connection, "Test", "Extra values");
+    }
+    alup.Run();
+}
@@ -0,0 +1,137 @@
+#ifndef DATAGRAM_CONNECTION_H
+#define DATAGRAM_CONNECTION_H
+
+#include "Connection.h"
+#include "FrameReassembler.h"
+#include <deque>
+#include <vector>
+
+/**
+ * class implementing an in-memory datagram connection which receives like UdpConnection
+ * Without fragmentation the datagrams form a plain byte stream; with it, each datagram is a fragment which is
+ * added to a FrameReassembler, see ConfigurationOption::FRAGMENTATION.
+ * Note: the datagrams to receive have to be provided using Feed(); everything sent ends up in sent
+ */
+class DatagramConnection final : public Connection
+{
+    public:
+        //the bytes sent by the device
+        std::vector<uint8_t> sent;
+        bool connected = false;
+        //reassembles the frames received in fragments
+        FrameReassembler reassembler;
+        //if datagrams carry fragments instead of a plain byte stream
+        bool fragmentation = false;
+
+        void Connect()
+        {
+            SetFragmentation(false);
+            connected = true;
+        }
+
+        void Disconnect()
+        {
+            connected = false;
+        }
+
+        void Send(uint8_t* bytes, size_t length)
+        {
+            sent.insert(sent.end(), bytes, bytes + length);
+        }
+
+        /**
+         * function receiving the given amount of bytes
+         * Note: never blocks as nothing could receive datagrams while waiting;
+         * returns the number of bytes which were available instead
+         * @param buffer: a pre-initialized buffer of the given size
+         * @param length: the size of the buffer
+         * @return: the number of bytes read
+         */
+        int Read(uint8_t* buffer, size_t length)
+        {
+            size_t count = 0;
+            while(count < length && Available() > 0)
+            {
+                if(fragmentation)
+                {
+                    count += reassembler.Read(&buffer[count], length - count);
+                    continue;
+                }
+                std::vector<uint8_t>& datagram = datagrams.front();
+                size_t read = datagram.size() - readPosition < length - count ? datagram.size() - readPosition : length - count;
+                memcpy(&buffer[count], &datagram[readPosition], read);
+                count += read;
+                readPosition += read;
+            }
+            return count;
+        }
+
+        int Available()
+        {
+            if(fragmentation)
+            {
+                //a frame being read is completed before newer ones are received
+                if(!reassembler.Reading())
+                {
+                    ReceiveFragments();
+                }
+                return reassembler.Available();
+            }
+            //parse the next datagram once the current one was read
+            while(!datagrams.empty() && readPosition == datagrams.front().size())
+            {
+                datagrams.pop_front();
+                readPosition = 0;
+            }
+            return datagrams.empty() ? 0 : datagrams.front().size() - readPosition;
+        }
+
+        bool isConnected()
+        {
+            return connected;
+        }
+
+        bool SupportsFragmentation()
+        {
+            return true;
+        }
+
+        void SetFragmentation(bool enabled)
+        {
+            fragmentation = enabled;
+            reassembler.Reset();
+        }
+
+        /**
+         * function receiving the given datagram
+         */
+        void Feed(const std::vector<uint8_t>& datagram)
+        {
+            datagrams.push_back(datagram);
+        }
+
+    private:
+        //the datagrams received but not parsed yet; the front one is being read without fragmentation
+        std::deque<std::vector<uint8_t>> datagrams;
+        size_t readPosition = 0;
+
+        /**
+         * function adding all datagrams received so far to the reassembler like UdpConnection::ReceiveFragments()
+         */
+        void ReceiveFragments()
+        {
+            //the rest of a plain datagram read before fragmentation was enabled is discarded
+            if(readPosition > 0)
+            {
+                datagrams.pop_front();
+                readPosition = 0;
+            }
+            while(!datagrams.empty())
+            {
+                reassembler.Add(datagrams.front().data(), datagrams.front().size());
+                datagrams.pop_front();
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,321 @@
+#ifndef INTERACTIVE_MASTER_H
+#define INTERACTIVE_MASTER_H
+
+#include "ALUP.h"
+#include "LoopbackConnection.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//the time the master waits between two polls of its connection in microseconds
+#define INTERACTIVE_MASTER_POLL_TIME 50
+//the time the master waits for answers of the device in microseconds
+#define INTERACTIVE_MASTER_TIMEOUT 1000000
+//the time the master waits after switching the baud rate before sending the verification burst in microseconds
+#define INTERACTIVE_MASTER_SWITCH_DELAY 1000
+
+/**
+ * class letting a device and a master take turns on two threads
+ */
+class Turns
+{
+    public:
+        /**
+         * function handing over to the other side and waiting until it hands back
+         * Note: returns immediately once the device finished
+         * @param device: if the calling side is the device
+         */
+        void Pass(bool device)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            deviceTurn = !device;
+            changed.notify_all();
+            changed.wait(lock, [&] { return finished || deviceTurn == device; });
+        }
+
+        /**
+         * function waiting until it is the turn of the master
+         */
+        void WaitForMaster()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return finished || !deviceTurn; });
+        }
+
+        /**
+         * function returning if the device finished
+         */
+        bool Finished()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            return finished;
+        }
+
+        /**
+         * function handing over to the master for good
+         */
+        void Finish()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished = true;
+            changed.notify_all();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool deviceTurn = true;
+        bool finished = false;
+};
+
+/**
+ * class implementing the master end of a simulated link as blocking code, like a master on a computer
+ * While connecting, the device runs Alup::Connect() on a second thread; both take turns so that each side
+ * can wait for the other one in simulated time and the master can answer depending on what the device sent.
+ * Note: meant to be used with HostClock::Simulate(true)
+ */
+class InteractiveMaster
+{
+    public:
+        /**
+         * default constructor
+         * @param _connection: the master end of the link
+         */
+        InteractiveMaster(LoopbackConnection& _connection) : connection {_connection}
+        {
+
+        }
+
+        LoopbackConnection& connection;
+
+        //if the last Connect() resumed the session
+        bool resumed = false;
+
+        /**
+         * function connecting the given device
+         * The master answers the connection request and the configuration, calls negotiate(*this) to
+         * negotiate configuration options and acknowledges the configuration. If a session token is given,
+         * the master tries to resume the session first, see ConfigurationOption::SESSION.
+         * @param alup: the device
+         * @param device: the device end of the link
+         * @param negotiate: function negotiating options; returns false if the device answered wrong
+         * @param token: the token of the session to resume; 0 to start a new session
+         * @return: 1 if the device connected and the options were negotiated or the session resumed, else 0
+         */
+        template<class AlupT, class F>
+        int Connect(AlupT& alup, LoopbackConnection& device, F negotiate, uint32_t token = 0)
+        {
+            Turns deviceTurns;
+            turns = &deviceTurns;
+            device.onIdle = [&] { deviceTurns.Pass(true); };
+            int connected = 0;
+            std::thread deviceThread([&] {
+                connected = alup.Connect(&device, "Bench", "");
+                deviceTurns.Finish();
+            });
+            deviceTurns.WaitForMaster();
+
+            resumed = false;
+            bool answered = AnswerConnectionRequest(token) && (resumed || negotiate(*this));
+            if(!resumed)
+            {
+                uint8_t acknowledgement = CONFIGURATION_ACKNOWLEDGEMENT_BYTE;
+                connection.Send(&acknowledgement, 1);
+            }
+            //let the device read the acknowledgement
+            Wait(INTERACTIVE_MASTER_POLL_TIME);
+            if(!deviceTurns.Finished())
+            {
+                printf("the device did not finish connecting\n");
+                exit(1);
+            }
+            deviceThread.join();
+            device.onIdle = nullptr;
+            turns = nullptr;
+            return answered && connected;
+        }
+
+        /**
+         * function receiving the given number of bytes, letting the device run while waiting
+         * @param timeout: the time to wait in microseconds
+         * @return: false if they were not received in time
+         */
+        bool Receive(uint8_t* buffer, int length, unsigned long timeout = INTERACTIVE_MASTER_TIMEOUT)
+        {
+            unsigned long start = HostClock::Micros();
+            while(connection.Available() < length)
+            {
+                if(HostClock::Micros() - start >= timeout)
+                {
+                    return false;
+                }
+                Yield();
+                if(connection.Available() < length)
+                {
+                    HostClock::Advance(INTERACTIVE_MASTER_POLL_TIME);
+                }
+            }
+            connection.Read(buffer, length);
+            return true;
+        }
+
+        /**
+         * function letting the device run for the given time in microseconds
+         */
+        void Wait(unsigned long time)
+        {
+            unsigned long start = HostClock::Micros();
+            while(HostClock::Micros() - start < time)
+            {
+                Yield();
+                HostClock::Advance(INTERACTIVE_MASTER_POLL_TIME);
+            }
+        }
+
+        /**
+         * function discarding the bytes received
+         */
+        void Discard()
+        {
+            uint8_t discarded[64];
+            while(connection.Available() > 0)
+            {
+                connection.Read(discarded, sizeof(discarded));
+            }
+        }
+
+        /**
+         * function requesting a configuration option and reading the answer
+         * @param answer: the accepted value
+         * @return: false if there was no valid answer
+         */
+        bool Option(uint8_t option, const std::vector<uint8_t>& value, std::vector<uint8_t>& answer)
+        {
+            std::vector<uint8_t> request = {CONFIGURATION_OPTION_BYTE, option, (uint8_t) value.size()};
+            request.insert(request.end(), value.begin(), value.end());
+            connection.Send(request.data(), request.size());
+            uint8_t header[3];
+            if(!Receive(header, 3) || header[0] != CONFIGURATION_OPTION_BYTE || header[1] != option)
+            {
+                return false;
+            }
+            answer.resize(header[2]);
+            return Receive(answer.data(), header[2]);
+        }
+
+        /**
+         * function switching to the highest baud rate supported by both sides which passes the verification,
+         * see ConfigurationOption::BAUD_RATE
+         * @param supported: the rates the master supports
+         * @return: the rate used afterwards
+         */
+        long NegotiateBaudRate(const std::vector<long>& supported)
+        {
+            std::vector<uint8_t> answer;
+            if(!Option(ConfigurationOption::BAUD_RATE, std::vector<uint8_t>(), answer))
+            {
+                return connection.GetBaudRate();
+            }
+            std::vector<long> rates;
+            for(size_t i = 0; i + 4 <= answer.size(); i += 4)
+            {
+                long rate = Convert::BytesToInt32(&answer[i]);
+                if(rate > connection.GetBaudRate() && std::find(supported.begin(), supported.end(), rate) != supported.end())
+                {
+                    rates.push_back(rate);
+                }
+            }
+            std::sort(rates.rbegin(), rates.rend());
+
+            const uint8_t pattern[] = BAUD_RATE_VERIFY_PATTERN;
+            uint8_t burst[BAUD_RATE_VERIFY_SIZE];
+            for(int i = 0; i < BAUD_RATE_VERIFY_SIZE; i++)
+            {
+                burst[i] = pattern[i % BAUD_RATE_VERIFY_PATTERN_SIZE];
+            }
+            for(long rate : rates)
+            {
+                std::vector<uint8_t> value(4);
+                Convert::Int32ToBytes(rate, value.data());
+                if(!Option(ConfigurationOption::BAUD_RATE, value, answer) || answer.size() < 4 || Convert::BytesToInt32(answer.data()) != rate)
+                {
+                    continue;
+                }
+                long previous = connection.GetBaudRate();
+                connection.SetBaudRate(rate);
+                Wait(INTERACTIVE_MASTER_SWITCH_DELAY);
+                connection.Send(burst, sizeof(burst));
+                uint8_t echo[BAUD_RATE_VERIFY_SIZE];
+                if(Receive(echo, sizeof(echo), BAUD_RATE_VERIFY_TIMEOUT * 1000) && memcmp(echo, burst, sizeof(burst)) == 0)
+                {
+                    uint8_t confirmation = BAUD_RATE_CONFIRMATION_BYTE;
+                    connection.Send(&confirmation, 1);
+                    return rate;
+                }
+                //fall back and wait until the device did the same
+                connection.SetBaudRate(previous);
+                Wait(BAUD_RATE_VERIFY_TIMEOUT * 1000);
+                Discard();
+            }
+            return connection.GetBaudRate();
+        }
+
+    private:
+        //the turns of the device while it connects; nullptr if it does not run on another thread
+        Turns* turns = nullptr;
+
+        /**
+         * function letting the device run if it connects on another thread
+         */
+        void Yield()
+        {
+            if(turns != nullptr)
+            {
+                turns->Pass(false);
+            }
+        }
+
+        /**
+         * function answering the connection request and reading the configuration unless the session was resumed
+         * @param token: the token of the session to resume; 0 to start a new session
+         * @return: false if the device did not answer
+         */
+        bool AnswerConnectionRequest(uint32_t token)
+        {
+            uint8_t byte = 0;
+            while(byte != CONNECTION_REQUEST_BYTE)
+            {
+                if(!Receive(&byte, 1))
+                {
+                    return false;
+                }
+            }
+            uint8_t answer[5] = {CONNECTION_ACKNOWLEDGEMENT_BYTE};
+            if(token != 0)
+            {
+                answer[0] = SESSION_RESUME_BYTE;
+                Convert::Int32ToBytes(token, &answer[1]);
+            }
+            connection.Send(answer, token != 0 ? 5 : 1);
+
+            //skip further connection requests; the configuration is sent at once
+            while(byte != CONFIGURATION_START_BYTE)
+            {
+                if(!Receive(&byte, 1))
+                {
+                    return false;
+                }
+                if(byte == SESSION_RESUME_BYTE)
+                {
+                    uint8_t echo[4];
+                    resumed = Receive(echo, 4) && memcmp(echo, &answer[1], 4) == 0;
+                    return resumed;
+                }
+            }
+            Discard();
+            return true;
+        }
+};
+
+#endif
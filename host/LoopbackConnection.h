@@ -0,0 +1,282 @@
+#ifndef LOOPBACK_CONNECTION_H
+#define LOOPBACK_CONNECTION_H
+
+#include "Connection.h"
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/**
+ * class implementing one end of a simulated link between two connections on the host
+ * Bytes sent are delivered to the paired connection after the given latency, a random jitter and
+ * the time needed to transfer them at the given rate, all measured using HostClock::Micros().
+ * Bytes are always delivered in the order they were sent.
+ * If a baud rate is set, it determines the transfer rate; bytes received using a different rate than they were
+ * sent with, or sent faster than maxBaud, arrive as 0.
+ * Note: meant to be used with HostClock::Simulate(true); a blocking Read() then advances the
+ * simulated time until the requested bytes were delivered
+ */
+class LoopbackConnection : public Connection
+{
+    public:
+        /**
+         * default constructor
+         * @param _latency: the time in microseconds until sent bytes arrive
+         * @param _bytesPerSecond: the transfer rate of the link; 0 for unlimited
+         * @param _jitter: the maximum additional latency of each Send() in microseconds, chosen using rand()
+         */
+        LoopbackConnection(unsigned long _latency = 0, unsigned long _bytesPerSecond = 0, unsigned long _jitter = 0) : latency {_latency}, bytesPerSecond {_bytesPerSecond}, jitter {_jitter}
+        {
+
+        }
+
+        /**
+         * function connecting the two given connections with each other
+         */
+        static void Pair(LoopbackConnection& a, LoopbackConnection& b)
+        {
+            a.peer = &b;
+            b.peer = &a;
+        }
+
+        bool connected = false;
+        //the baud rates offered by GetBaudRates(); empty if the rate can not be changed
+        std::vector<long> baudRates;
+        //the highest baud rate the line transfers without errors; 0 for any
+        long maxBaud = 0;
+        //called when nothing is available to read, e.g. to let the other end run on another thread
+        std::function<void()> onIdle;
+
+        void Connect()
+        {
+            connected = true;
+        }
+
+        void Disconnect()
+        {
+            connected = false;
+        }
+
+        void Send(uint8_t* bytes, size_t length)
+        {
+            if(peer == nullptr || length == 0)
+            {
+                return;
+            }
+
+            //the bytes are sent one after another over the link
+            unsigned long now = HostClock::Micros();
+            unsigned long start = (long) (lineFreeAt - now) > 0 ? lineFreeAt : now;
+            lineFreeAt = start + (bytesPerSecond > 0 ? (unsigned long long) length * 1000000 / bytesPerSecond : 0);
+
+            Packet packet;
+            packet.deliveryTime = lineFreeAt + latency + (jitter > 0 ? rand() % jitter : 0);
+            if(!peer->incoming.empty() && (long) (peer->incoming.back().deliveryTime - packet.deliveryTime) > 0)
+            {
+                //keep the order of the bytes
+                packet.deliveryTime = peer->incoming.back().deliveryTime;
+            }
+            packet.bytes.assign(bytes, bytes + length);
+            packet.baud = baud;
+            if(maxBaud > 0 && baud > maxBaud)
+            {
+                std::fill(packet.bytes.begin(), packet.bytes.end(), 0);
+            }
+            peer->incoming.push_back(packet);
+        }
+
+        /**
+         * function receiving the given amount of bytes
+         * Note: blocks until the given amount was read; returns less if nothing more is in transit
+         * @param buffer: a pre-initialized buffer of the given size
+         * @param length: the size of the buffer
+         * @return: the number of bytes read
+         */
+        int Read(uint8_t* buffer, size_t length)
+        {
+            size_t count = 0;
+            while(count < length)
+            {
+                count += ReadDelivered(buffer + count, length - count);
+                if(count < length && !WaitForDelivery())
+                {
+                    if(!onIdle)
+                    {
+                        break;
+                    }
+                    onIdle();
+                }
+            }
+            return count;
+        }
+
+        int Available()
+        {
+            int count = Delivered();
+            if(count == 0 && onIdle)
+            {
+                onIdle();
+                count = Delivered();
+            }
+            return count;
+        }
+
+        bool isConnected()
+        {
+            return connected;
+        }
+
+        /**
+         * function returning if bytes are still on their way to this connection
+         */
+        bool InTransit()
+        {
+            return !incoming.empty();
+        }
+
+        /**
+         * function simulating a lost link: the bytes in transit in both directions are lost and
+         * this end is disconnected until Connect() is called
+         */
+        void Drop()
+        {
+            connected = false;
+            incoming.clear();
+            if(peer != nullptr)
+            {
+                peer->incoming.clear();
+            }
+        }
+
+        /**
+         * function setting the baud rate and the transfer rate of the link (10 bits per byte)
+         * Note: use it before connecting; SetBaudRate() waits until the bytes sent were transmitted
+         */
+        void SetInitialBaudRate(long _baud)
+        {
+            baud = _baud;
+            bytesPerSecond = _baud / 10;
+        }
+
+        long GetBaudRate()
+        {
+            return baud;
+        }
+
+        int GetBaudRates(long* rates, int maxCount)
+        {
+            int count = 0;
+            for(long rate : baudRates)
+            {
+                if(count < maxCount)
+                {
+                    rates[count++] = rate;
+                }
+            }
+            return count;
+        }
+
+        bool SetBaudRate(long _baud)
+        {
+            if(baud == 0)
+            {
+                return false;
+            }
+            if((long) (lineFreeAt - HostClock::Micros()) > 0)
+            {
+                delayMicroseconds(lineFreeAt - HostClock::Micros());
+            }
+            SetInitialBaudRate(_baud);
+            return true;
+        }
+
+    private:
+        struct Packet
+        {
+            unsigned long deliveryTime;
+            std::vector<uint8_t> bytes;
+            size_t position = 0;
+            //the baud rate the bytes were sent with
+            long baud = 0;
+        };
+
+        unsigned long latency;
+        unsigned long bytesPerSecond;
+        unsigned long jitter;
+        //the time at which the link finished sending the previous bytes
+        unsigned long lineFreeAt = 0;
+        //the baud rate of this end; 0 if the link has no baud rate
+        long baud = 0;
+        LoopbackConnection* peer = nullptr;
+        std::deque<Packet> incoming;
+
+        /**
+         * function returning the number of bytes which have already been delivered
+         */
+        int Delivered()
+        {
+            unsigned long now = HostClock::Micros();
+            size_t count = 0;
+            for(size_t i = 0; i < incoming.size() && (long) (now - incoming[i].deliveryTime) >= 0; i++)
+            {
+                count += incoming[i].bytes.size() - incoming[i].position;
+            }
+            return count;
+        }
+
+        /**
+         * function reading the bytes which have already been delivered
+         * @return: the number of bytes read
+         */
+        size_t ReadDelivered(uint8_t* buffer, size_t length)
+        {
+            unsigned long now = HostClock::Micros();
+            size_t count = 0;
+            while(count < length && !incoming.empty() && (long) (now - incoming.front().deliveryTime) >= 0)
+            {
+                Packet& packet = incoming.front();
+                size_t chunk = packet.bytes.size() - packet.position;
+                if(chunk > length - count)
+                {
+                    chunk = length - count;
+                }
+                if(packet.baud == baud)
+                {
+                    memcpy(buffer + count, packet.bytes.data() + packet.position, chunk);
+                }
+                else
+                {
+                    //received using the wrong baud rate
+                    memset(buffer + count, 0, chunk);
+                }
+                packet.position += chunk;
+                count += chunk;
+                if(packet.position == packet.bytes.size())
+                {
+                    incoming.pop_front();
+                }
+            }
+            return count;
+        }
+
+        /**
+         * function waiting until the next bytes in transit are delivered
+         * @return: false if nothing is in transit
+         */
+        bool WaitForDelivery()
+        {
+            if(incoming.empty())
+            {
+                return false;
+            }
+            long remaining = (long) (incoming.front().deliveryTime - HostClock::Micros());
+            if(remaining > 0)
+            {
+                delayMicroseconds(remaining);
+            }
+            return true;
+        }
+};
+
+#endif
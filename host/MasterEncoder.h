@@ -0,0 +1,251 @@
+#ifndef MASTER_ENCODER_H
+#define MASTER_ENCODER_H
+
+/**
+ * master side encoders for the frame bodies understood by Alup, used by the host benchmarks
+ */
+
+#include "ALUP.h"
+#include "Convert.h"
+#include <vector>
+
+/**
+ * a range of consecutive leds sent in a SCATTER body
+ */
+struct ScatterSegment
+{
+    //the index of the first led, relative to the frame offset
+    int32_t offset;
+    std::vector<CRGB> colors;
+};
+
+class MasterEncoder
+{
+    public:
+        /**
+         * function encoding the given colors as a RUN_LENGTH body
+         * @param colors: the colors of consecutive leds
+         * @return: the body
+         */
+        static std::vector<uint8_t> RunLength(const std::vector<CRGB>& colors)
+        {
+            std::vector<uint8_t> body;
+            size_t i = 0;
+            while(i < colors.size())
+            {
+                size_t count = 1;
+                while(i + count < colors.size() && count < 256 && colors[i + count] == colors[i])
+                {
+                    count++;
+                }
+                body.push_back(count - 1);
+                body.push_back(colors[i].r);
+                body.push_back(colors[i].g);
+                body.push_back(colors[i].b);
+                i += count;
+            }
+            return body;
+        }
+
+        /**
+         * function encoding the changes from the previous to the current colors as a DELTA body
+         * Note: unchanged gaps shorter than a span header are included in the spans
+         * @param previous: the colors currently shown by the device
+         * @param current: the new colors; has to have the size of previous
+         * @return: the body
+         */
+        static std::vector<uint8_t> Delta(const std::vector<CRGB>& previous, const std::vector<CRGB>& current)
+        {
+            std::vector<uint8_t> body;
+            size_t position = 0;
+            size_t i = 0;
+            while(i < current.size())
+            {
+                if(current[i] == previous[i])
+                {
+                    i++;
+                    continue;
+                }
+
+                //extend the span while the gaps are too short to be worth a new span
+                size_t end = i + 1;
+                size_t last = i + 1;
+                while(end < current.size() && end - last < 2 && last - i < 65535)
+                {
+                    if(current[end] != previous[end])
+                    {
+                        last = end + 1;
+                    }
+                    end++;
+                }
+
+                //skip at most 65535 leds per span header
+                while(i - position > 65535)
+                {
+                    AppendSpanHeader(body, 65535, 0);
+                    position += 65535;
+                }
+                AppendSpanHeader(body, i - position, last - i);
+                for(size_t j = i; j < last; j++)
+                {
+                    body.push_back(current[j].r ^ previous[j].r);
+                    body.push_back(current[j].g ^ previous[j].g);
+                    body.push_back(current[j].b ^ previous[j].b);
+                }
+                position = last;
+                i = last;
+            }
+            return body;
+        }
+
+        /**
+         * function building a palette containing all colors of the given leds
+         * @param colors: the colors of the leds
+         * @param maxEntries: the maximum number of palette entries
+         * @param palette: the resulting palette
+         * @return: false if the colors do not fit into the palette
+         */
+        static bool BuildPalette(const std::vector<CRGB>& colors, size_t maxEntries, std::vector<CRGB>& palette)
+        {
+            palette.clear();
+            for(const CRGB& color : colors)
+            {
+                if(PaletteIndex(palette, color) >= 0)
+                {
+                    continue;
+                }
+                if(palette.size() == maxEntries)
+                {
+                    return false;
+                }
+                palette.push_back(color);
+            }
+            return true;
+        }
+
+        /**
+         * function encoding the given colors as a PALETTE_8 body
+         * @param colors: the colors of consecutive leds; all have to be in the palette
+         * @param palette: the palette uploaded to the device
+         */
+        static std::vector<uint8_t> Palette8(const std::vector<CRGB>& colors, const std::vector<CRGB>& palette)
+        {
+            std::vector<uint8_t> body;
+            for(const CRGB& color : colors)
+            {
+                body.push_back(PaletteIndex(palette, color));
+            }
+            return body;
+        }
+
+        /**
+         * function encoding the given colors as a PALETTE_4 body
+         * @param colors: the colors of consecutive leds; all have to be in the first 16 palette entries
+         * @param palette: the palette uploaded to the device
+         */
+        static std::vector<uint8_t> Palette4(const std::vector<CRGB>& colors, const std::vector<CRGB>& palette)
+        {
+            std::vector<uint8_t> body;
+            for(size_t i = 0; i < colors.size(); i += 2)
+            {
+                uint8_t high = PaletteIndex(palette, colors[i]);
+                //an odd number of leds is padded with the color of the last one
+                uint8_t low = PaletteIndex(palette, colors[i + 1 < colors.size() ? i + 1 : i]);
+                body.push_back((high << 4) | low);
+            }
+            return body;
+        }
+
+        /**
+         * function encoding the given colors as a RGB565 body
+         * @param colors: the colors of consecutive leds; truncated to 5/6/5 bits
+         */
+        static std::vector<uint8_t> Rgb565(const std::vector<CRGB>& colors)
+        {
+            std::vector<uint8_t> body;
+            for(const CRGB& color : colors)
+            {
+                uint16_t packed = ((color.r >> 3) << 11) | ((color.g >> 2) << 5) | (color.b >> 3);
+                body.push_back(packed >> 8);
+                body.push_back(packed & 0xFF);
+            }
+            return body;
+        }
+
+        /**
+         * function encoding the given colors as a RGB444 body
+         * @param colors: the colors of consecutive leds; truncated to 4 bits per channel
+         */
+        static std::vector<uint8_t> Rgb444(const std::vector<CRGB>& colors)
+        {
+            std::vector<uint8_t> body;
+            for(size_t i = 0; i < colors.size(); i += 2)
+            {
+                //an odd number of leds is padded with the color of the last one
+                const CRGB& first = colors[i];
+                const CRGB& second = colors[i + 1 < colors.size() ? i + 1 : i];
+                body.push_back((first.r & 0xF0) | (first.g >> 4));
+                body.push_back((first.b & 0xF0) | (second.r >> 4));
+                body.push_back((second.g & 0xF0) | (second.b >> 4));
+            }
+            return body;
+        }
+
+        /**
+         * function encoding the given ranges of leds as a SCATTER body
+         * @param segments: the ranges; each has at most 65535 leds
+         */
+        static std::vector<uint8_t> Scatter(const std::vector<ScatterSegment>& segments)
+        {
+            std::vector<uint8_t> body;
+            for(const ScatterSegment& segment : segments)
+            {
+                uint8_t offset[4];
+                Convert::Int32ToBytes(segment.offset, offset);
+                body.insert(body.end(), offset, offset + 4);
+                body.push_back(segment.colors.size() >> 8);
+                body.push_back(segment.colors.size() & 0xFF);
+                std::vector<uint8_t> colors = Raw(segment.colors);
+                body.insert(body.end(), colors.begin(), colors.end());
+            }
+            return body;
+        }
+
+        /**
+         * function encoding the given colors as a raw v0.2 body
+         */
+        static std::vector<uint8_t> Raw(const std::vector<CRGB>& colors)
+        {
+            std::vector<uint8_t> body;
+            for(const CRGB& color : colors)
+            {
+                body.push_back(color.r);
+                body.push_back(color.g);
+                body.push_back(color.b);
+            }
+            return body;
+        }
+
+    private:
+        static int PaletteIndex(const std::vector<CRGB>& palette, const CRGB& color)
+        {
+            for(size_t i = 0; i < palette.size(); i++)
+            {
+                if(palette[i] == color)
+                {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        static void AppendSpanHeader(std::vector<uint8_t>& body, size_t skip, size_t count)
+        {
+            body.push_back(skip >> 8);
+            body.push_back(skip & 0xFF);
+            body.push_back(count >> 8);
+            body.push_back(count & 0xFF);
+        }
+};
+
+#endif
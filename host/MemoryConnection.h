@@ -0,0 +1,100 @@
+#ifndef MEMORY_CONNECTION_H
+#define MEMORY_CONNECTION_H
+
+#include "Connection.h"
+#include <vector>
+
+/**
+ * class implementing an in-memory connection for running this library on a host
+ * Note: the bytes to receive have to be provided using Feed(); everything sent ends up in sent
+ */
+class MemoryConnection final : public Connection
+{
+    public:
+        //the bytes sent by the device
+        std::vector<uint8_t> sent;
+        bool connected = false;
+
+        void Connect()
+        {
+            connected = true;
+        }
+
+        void Disconnect()
+        {
+            connected = false;
+        }
+
+        void Send(uint8_t* bytes, size_t length)
+        {
+            sent.insert(sent.end(), bytes, bytes + length);
+        }
+
+        /**
+         * function receiving the given amount of bytes
+         * Note: never blocks as nothing could fill the buffer while waiting;
+         * returns the number of bytes which were available instead
+         * @param buffer: a pre-initialized buffer of the given size
+         * @param length: the size of the buffer
+         * @return: the number of bytes read
+         */
+        int Read(uint8_t* buffer, size_t length)
+        {
+            size_t count = received.size() - readPosition;
+            if(count > length)
+            {
+                count = length;
+            }
+            memcpy(buffer, received.data() + readPosition, count);
+            readPosition += count;
+            return count;
+        }
+
+        int Available()
+        {
+            return received.size() - readPosition;
+        }
+
+        bool isConnected()
+        {
+            return connected;
+        }
+
+        /**
+         * function appending the given bytes to the receive buffer
+         */
+        void Feed(const uint8_t* bytes, size_t length)
+        {
+            received.insert(received.end(), bytes, bytes + length);
+        }
+
+        void Feed(const std::vector<uint8_t>& bytes)
+        {
+            Feed(bytes.data(), bytes.size());
+        }
+
+        /**
+         * function making all bytes of the receive buffer available again
+         * Note: used to replay the same frames without copying them
+         */
+        void Rewind()
+        {
+            readPosition = 0;
+        }
+
+        /**
+         * function emptying the receive and send buffers
+         */
+        void Clear()
+        {
+            received.clear();
+            readPosition = 0;
+            sent.clear();
+        }
+
+    private:
+        std::vector<uint8_t> received;
+        size_t readPosition = 0;
+};
+
+#endif
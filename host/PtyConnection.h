@@ -0,0 +1,257 @@
+#ifndef PTY_CONNECTION_H
+#define PTY_CONNECTION_H
+
+#include "Connection.h"
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+//the time a blocking call waits at most before checking the connection again in ms
+#define PTY_CONNECTION_POLL_TIME 100
+
+/**
+ * class implementing a serial connection over a pseudo-terminal, which lets a device and a master exchange
+ * real bytes on one machine like over a USB serial adapter
+ * The line speed of the simulated baud rate (10 bits per byte) is kept in both directions: sending waits
+ * until the previous bytes were transmitted, and received bytes become available at the rate they would arrive.
+ * Note: Read() blocks until the given amount was read or the connection was lost; Available() never blocks
+ */
+class PtyConnection final : public Connection
+{
+    public:
+        //the path of the serial device, e.g. /dev/pts/3; the other side opens it like a serial port
+        std::string path;
+        bool connected = false;
+        //the baud rates the connection can switch to, see ConfigurationOption::BAUD_RATE; empty for a fixed rate
+        std::vector<long> baudRates;
+
+        /**
+         * default constructor
+         * @param _baud: the simulated baud rate
+         * @param _path: the serial device to open, e.g. the path of another PtyConnection or a real serial port;
+         *               nullptr to create a new pseudo-terminal, of which the path is stored in path
+         */
+        PtyConnection(long _baud, const char* _path = nullptr) : baud {_baud}
+        {
+            if(_path != nullptr)
+            {
+                path = _path;
+                return;
+            }
+            fd = posix_openpt(O_RDWR | O_NOCTTY);
+            if(fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+            {
+                return;
+            }
+            path = ptsname(fd);
+            //keep the other side open, else reading fails while no master opened it
+            peerFd = open(path.c_str(), O_RDWR | O_NOCTTY);
+            MakeRaw(peerFd);
+        }
+
+        ~PtyConnection()
+        {
+            Disconnect();
+            if(peerFd >= 0)
+            {
+                close(peerFd);
+                close(fd);
+            }
+        }
+
+        /**
+         * function opening the serial device given to the constructor; a new pseudo-terminal is already open
+         */
+        void Connect()
+        {
+            if(fd < 0 && !path.empty())
+            {
+                fd = open(path.c_str(), O_RDWR | O_NOCTTY);
+                MakeRaw(fd);
+            }
+            lineFreeAt = Clock::now();
+            lastReceive = Clock::now();
+            connected = fd >= 0;
+        }
+
+        /**
+         * function closing a serial device opened by Connect()
+         * Note: a new pseudo-terminal stays open so that its path does not change
+         */
+        void Disconnect()
+        {
+            if(fd >= 0 && peerFd < 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+            connected = false;
+        }
+
+        /**
+         * function sending the given bytes once the previous bytes were transmitted
+         * @param bytes: the bytes to send
+         * @param length: the length of the bytes array
+         */
+        void Send(uint8_t* bytes, size_t length)
+        {
+            std::this_thread::sleep_until(lineFreeAt);
+            size_t count = 0;
+            while(connected && count < length)
+            {
+                ssize_t written = write(fd, &bytes[count], length - count);
+                if(written < 0)
+                {
+                    connected = false;
+                    return;
+                }
+                count += written;
+            }
+            lineFreeAt = Clock::now() + ByteTime() * length;
+        }
+
+        /**
+         * function reading the given amount of bytes into the given buffer
+         * Note: blocks until the bytes arrived or the connection was lost
+         * @param buffer: a buffer for the incoming bytes
+         * @param length: the number of bytes to read
+         * @return: the number of bytes filled into the buffer
+         */
+        int Read(uint8_t* buffer, size_t length)
+        {
+            size_t count = 0;
+            while(count < length && connected)
+            {
+                int available = Available();
+                if(available <= 0)
+                {
+                    if(!Pending())
+                    {
+                        pollfd readable = {fd, POLLIN, 0};
+                        poll(&readable, 1, PTY_CONNECTION_POLL_TIME);
+                        continue;
+                    }
+                    //wait until the next byte arrived
+                    std::this_thread::sleep_for(ByteTime());
+                    continue;
+                }
+                size_t read = (size_t) available < length - count ? available : length - count;
+                ssize_t received = ::read(fd, &buffer[count], read);
+                if(received <= 0)
+                {
+                    //the other side closed the terminal
+                    connected = received < 0 && (errno == EAGAIN || errno == EINTR);
+                    continue;
+                }
+                count += received;
+                lastReceive += ByteTime() * received;
+            }
+            return count;
+        }
+
+        /**
+         * function returning the number of bytes which arrived at the simulated baud rate
+         * @return: the number of bytes available for read
+         */
+        int Available()
+        {
+            if(!connected || !Pending())
+            {
+                //the line was idle; the next bytes start arriving when they are written
+                lastReceive = Clock::now();
+                return 0;
+            }
+            int pending = 0;
+            ioctl(fd, FIONREAD, &pending);
+            long arrived = (Clock::now() - lastReceive) / ByteTime();
+            return arrived < pending ? arrived : pending;
+        }
+
+        bool isConnected()
+        {
+            return connected;
+        }
+
+        long GetBaudRate()
+        {
+            return baud;
+        }
+
+        int GetBaudRates(long* rates, int maxCount)
+        {
+            int count = 0;
+            for(long rate : baudRates)
+            {
+                if(count < maxCount)
+                {
+                    rates[count++] = rate;
+                }
+            }
+            return count;
+        }
+
+        /**
+         * function switching to the given baud rate after the bytes already sent were transmitted
+         * @param _baud: the new baud rate
+         * @return: always true
+         */
+        bool SetBaudRate(long _baud)
+        {
+            std::this_thread::sleep_until(lineFreeAt);
+            baud = _baud;
+            return true;
+        }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        long baud;
+        int fd = -1;
+        //the other side of a new pseudo-terminal; -1 if a serial device was opened
+        int peerFd = -1;
+        //the time the bytes sent are transmitted
+        Clock::time_point lineFreeAt;
+        //the time the bytes read so far arrived
+        Clock::time_point lastReceive;
+
+        /**
+         * function returning the time it takes to transmit a byte: a start bit, 8 data bits and a stop bit
+         */
+        std::chrono::nanoseconds ByteTime()
+        {
+            return std::chrono::nanoseconds(10 * 1000000000LL / baud);
+        }
+
+        /**
+         * function returning if bytes were written by the other side which were not read yet
+         */
+        bool Pending()
+        {
+            pollfd readable = {fd, POLLIN, 0};
+            return poll(&readable, 1, 0) > 0 && (readable.revents & POLLIN);
+        }
+
+        /**
+         * function switching the given terminal to raw mode so that every byte is passed unchanged
+         */
+        static void MakeRaw(int terminalFd)
+        {
+            termios settings;
+            if(terminalFd < 0 || tcgetattr(terminalFd, &settings) != 0)
+            {
+                return;
+            }
+            cfmakeraw(&settings);
+            tcsetattr(terminalFd, TCSANOW, &settings);
+        }
+};
+
+#endif
@@ -0,0 +1,350 @@
+#ifndef SOCKET_CONNECTION_H
+#define SOCKET_CONNECTION_H
+
+#include "Connection.h"
+#include "FrameReassembler.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+//the largest datagram which can be received
+#define SOCKET_CONNECTION_MAX_DATAGRAM 65536
+//the time a blocking call waits at most before checking the connection again in ms
+#define SOCKET_CONNECTION_POLL_TIME 100
+//the time between two attempts of a client to connect in ms
+#define SOCKET_CONNECTION_RETRY_TIME 10
+
+/**
+ * the kinds of sockets a SocketConnection can use
+ */
+enum SocketType
+{
+    //datagrams received on the local port and sent to the remote address, like UdpConnection
+    SOCKET_UDP,
+    //a stream accepted on the local port, like a device listening for its master
+    SOCKET_TCP_SERVER,
+    //a stream connected to the remote address, like a master
+    SOCKET_TCP_CLIENT
+};
+
+/**
+ * class implementing a connection over a POSIX socket, which lets a device and a master exchange real bytes
+ * on one machine or in a network
+ * Note: Read() blocks until the given amount was read or the connection was lost; Available() never blocks
+ */
+class SocketConnection final : public Connection
+{
+    public:
+        SocketType type;
+        //ip and port of the remote socket; not used by a TCP server
+        std::string ip;
+        int port;
+        //the port this socket is bound to; not used by a TCP client
+        int localPort;
+        bool connected = false;
+
+        //reassembles the frames received in fragments, see ConfigurationOption::FRAGMENTATION
+        FrameReassembler reassembler;
+        //if datagrams carry fragments instead of a plain byte stream
+        bool fragmentation = false;
+
+        /**
+         * default constructor
+         * @param _type: the kind of socket
+         * @param _ip: the ip address of the remote socket
+         * @param _port: the port of the remote socket
+         * @param _localPort: the port to bind to
+         */
+        SocketConnection(SocketType _type, const char* _ip, int _port, int _localPort) : type {_type}, ip {_ip}, port {_port}, localPort {_localPort}
+        {
+
+        }
+
+        ~SocketConnection()
+        {
+            Disconnect();
+        }
+
+        /**
+         * function opening the socket
+         * Note: a TCP server blocks until a client connected, a TCP client until the server accepted it
+         */
+        void Connect()
+        {
+            Close();
+            sockaddr_in remote = Address(ip.c_str(), port);
+            if(type == SOCKET_UDP)
+            {
+                fd = socket(AF_INET, SOCK_DGRAM, 0);
+                if(!Bind(fd))
+                {
+                    Close();
+                    return;
+                }
+                //only datagrams of the remote socket are received
+                ::connect(fd, (sockaddr*) &remote, sizeof(remote));
+            }
+            else if(type == SOCKET_TCP_SERVER)
+            {
+                if(listenFd < 0)
+                {
+                    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+                    if(!Bind(listenFd) || listen(listenFd, 1) != 0)
+                    {
+                        close(listenFd);
+                        listenFd = -1;
+                        return;
+                    }
+                }
+                fd = accept(listenFd, nullptr, nullptr);
+            }
+            else
+            {
+                while(true)
+                {
+                    fd = socket(AF_INET, SOCK_STREAM, 0);
+                    if(::connect(fd, (sockaddr*) &remote, sizeof(remote)) == 0)
+                    {
+                        break;
+                    }
+                    Close();
+                    usleep(SOCKET_CONNECTION_RETRY_TIME * 1000);
+                }
+            }
+            if(fd >= 0 && type != SOCKET_UDP)
+            {
+                //frames and acknowledgements are sent right away
+                int noDelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            }
+            //the connection request and the configuration are a plain byte stream
+            SetFragmentation(false);
+            connected = fd >= 0;
+        }
+
+        /**
+         * function closing the socket and, for a TCP server, the listening socket
+         */
+        void Disconnect()
+        {
+            Close();
+            if(listenFd >= 0)
+            {
+                close(listenFd);
+                listenFd = -1;
+            }
+            connected = false;
+        }
+
+        /**
+         * function sending the given bytes; in one datagram for UDP
+         * @param bytes: the bytes to send
+         * @param length: the length of the bytes array
+         */
+        void Send(uint8_t* bytes, size_t length)
+        {
+            size_t count = 0;
+            while(connected && count < length)
+            {
+                ssize_t sent = send(fd, &bytes[count], length - count, MSG_NOSIGNAL);
+                if(sent < 0)
+                {
+                    //a UDP socket reports datagrams which were not received, which does not end the connection
+                    connected = type == SOCKET_UDP;
+                    return;
+                }
+                count += sent;
+            }
+        }
+
+        /**
+         * function reading the given amount of bytes into the given buffer
+         * Note: blocks until the bytes were read or the connection was lost
+         * @param buffer: a buffer for the incoming bytes
+         * @param length: the number of bytes to read
+         * @return: the number of bytes filled into the buffer
+         */
+        int Read(uint8_t* buffer, size_t length)
+        {
+            size_t count = 0;
+            while(count < length && connected)
+            {
+                int available = Available();
+                if(available <= 0)
+                {
+                    pollfd readable = {fd, POLLIN, 0};
+                    poll(&readable, 1, SOCKET_CONNECTION_POLL_TIME);
+                    continue;
+                }
+                size_t read = (size_t) available < length - count ? available : length - count;
+                if(fragmentation)
+                {
+                    read = reassembler.Read(&buffer[count], read);
+                }
+                else if(type == SOCKET_UDP)
+                {
+                    memcpy(&buffer[count], &datagram[datagramPosition], read);
+                    datagramPosition += read;
+                }
+                else
+                {
+                    ssize_t received = recv(fd, &buffer[count], read, 0);
+                    read = received > 0 ? received : 0;
+                }
+                count += read;
+            }
+            return count;
+        }
+
+        /**
+         * function returning the number of bytes which can be read without blocking
+         * Without fragmentation, these are the rest of the last datagram for UDP.
+         * @return: the number of bytes available for read
+         */
+        int Available()
+        {
+            if(!connected)
+            {
+                return 0;
+            }
+            if(fragmentation)
+            {
+                //a frame being read is completed before newer ones are received
+                if(!reassembler.Reading())
+                {
+                    ReceiveFragments();
+                }
+                return reassembler.Available();
+            }
+            if(type == SOCKET_UDP)
+            {
+                if(datagramPosition == datagramSize)
+                {
+                    ReceiveDatagram();
+                }
+                return datagramSize - datagramPosition;
+            }
+            int available = 0;
+            ioctl(fd, FIONREAD, &available);
+            if(available == 0)
+            {
+                //a stream which is readable without bytes was closed by the other side
+                uint8_t byte;
+                ssize_t peeked = recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+                if(peeked == 0)
+                {
+                    connected = false;
+                }
+                else if(peeked > 0)
+                {
+                    //bytes arrived meanwhile
+                    ioctl(fd, FIONREAD, &available);
+                }
+            }
+            return available;
+        }
+
+        bool isConnected()
+        {
+            return connected;
+        }
+
+        /**
+         * function returning if frames can be received in fragments, see ConfigurationOption::FRAGMENTATION
+         * @return: true for UDP
+         */
+        bool SupportsFragmentation()
+        {
+            return type == SOCKET_UDP;
+        }
+
+        /**
+         * function switching between receiving a plain byte stream and frames reassembled from fragments
+         * @param enabled: true to receive reassembled frames
+         */
+        void SetFragmentation(bool enabled)
+        {
+            fragmentation = enabled && type == SOCKET_UDP;
+            reassembler.Reset();
+        }
+
+    private:
+        int fd = -1;
+        int listenFd = -1;
+        //the last datagram received and the number of its bytes read
+        std::vector<uint8_t> datagram = std::vector<uint8_t>(SOCKET_CONNECTION_MAX_DATAGRAM);
+        int datagramSize = 0;
+        int datagramPosition = 0;
+
+        /**
+         * function returning the address of the given ip and port
+         */
+        static sockaddr_in Address(const char* address, int addressPort)
+        {
+            sockaddr_in result = {};
+            result.sin_family = AF_INET;
+            result.sin_port = htons(addressPort);
+            inet_pton(AF_INET, address, &result.sin_addr);
+            return result;
+        }
+
+        /**
+         * function binding the given socket to the local port on all interfaces
+         * @return: false if the port is in use
+         */
+        bool Bind(int socketFd)
+        {
+            int reuse = 1;
+            setsockopt(socketFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            sockaddr_in local = Address("0.0.0.0", localPort);
+            return bind(socketFd, (sockaddr*) &local, sizeof(local)) == 0;
+        }
+
+        /**
+         * function receiving the next datagram without blocking
+         * @return: false if none was received
+         */
+        bool ReceiveDatagram()
+        {
+            ssize_t received = recv(fd, datagram.data(), datagram.size(), MSG_DONTWAIT);
+            if(received < 0)
+            {
+                return false;
+            }
+            datagramSize = received;
+            datagramPosition = 0;
+            return true;
+        }
+
+        /**
+         * function adding all datagrams received so far to the reassembler like UdpConnection::ReceiveFragments()
+         */
+        void ReceiveFragments()
+        {
+            while(ReceiveDatagram())
+            {
+                reassembler.Add(datagram.data(), datagramSize);
+            }
+            //a plain datagram read before fragmentation was enabled is discarded
+            datagramPosition = datagramSize;
+        }
+
+        void Close()
+        {
+            if(fd >= 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+            datagramSize = 0;
+            datagramPosition = 0;
+        }
+};
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * ALUP device running on a Linux host like src/main.cpp, so that a master can be tested without hardware
+ * The leds are not shown anywhere; the device prints the frames it applied every second.
+ * Usage:
+ *   alup_device udp <local port> <master ip> <master port> [led count]
+ *   alup_device tcp <local port> [led count]
+ *   alup_device pty <baud> [led count]    creates a pseudo-terminal and prints its path for the master
+ */
+
+#include "ALUP.h"
+#include "PtyConnection.h"
+#include "SocketConnection.h"
+#include <memory>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#define DEFAULT_LED_COUNT 300
+//the time between two status lines in ms
+#define STATUS_INTERVAL 1000
+
+/**
+ * function printing the usage
+ * @return: the exit code
+ */
+int Usage()
+{
+    printf("usage: alup_device udp <local port> <master ip> <master port> [led count]\n");
+    printf("       alup_device tcp <local port> [led count]\n");
+    printf("       alup_device pty <baud> [led count]\n");
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 3)
+    {
+        return Usage();
+    }
+    //the master may read the output through a pipe
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    std::string type = argv[1];
+    std::unique_ptr<Connection> connection;
+    int countArgument = 3;
+    if(type == "udp" && argc >= 5)
+    {
+        connection.reset(new SocketConnection(SOCKET_UDP, argv[3], atoi(argv[4]), atoi(argv[2])));
+        countArgument = 5;
+    }
+    else if(type == "tcp")
+    {
+        connection.reset(new SocketConnection(SOCKET_TCP_SERVER, "", 0, atoi(argv[2])));
+    }
+    else if(type == "pty")
+    {
+        PtyConnection* pty = new PtyConnection(atol(argv[2]));
+        connection.reset(pty);
+        if(pty->path.empty())
+        {
+            printf("could not create a pseudo-terminal\n");
+            return 1;
+        }
+        printf("serial device: %s\n", pty->path.c_str());
+    }
+    else
+    {
+        return Usage();
+    }
+    int ledCount = argc > countArgument ? atoi(argv[countArgument]) : DEFAULT_LED_COUNT;
+
+    //wait for the master in real time
+    HostClock::SleepInDelay(true);
+    std::vector<CRGB> leds(ledCount);
+    Alup alup(leds.data(), ledCount, 0, 0);
+    unsigned long lastStatus = millis();
+    uint32_t lastFrames = 0;
+    while(true)
+    {
+        if(!alup.connected)
+        {
+            printf("waiting for the master\n");
+            if(alup.Connect(connection.get(), "Host device", ""))
+            {
+                printf("connected\n");
+            }
+            continue;
+        }
+        alup.Run();
+        if(millis() - lastStatus >= STATUS_INTERVAL)
+        {
+            printf("%u frames/s, %u frame errors\n", alup.statistics.framesApplied - lastFrames, alup.statistics.frameErrors);
+            lastFrames = alup.statistics.framesApplied;
+            lastStatus = millis();
+        }
+        //leave the core to the master when nothing was received
+        if(connection->Available() <= 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+/**
+ * helpers shared by the host benchmarks
+ */
+
+#include "ALUP.h"
+#include "Convert.h"
+#include "MemoryConnection.h"
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+//the minimum time spent measuring each case
+#define BENCH_MIN_SECONDS 0.25
+#define BENCH_MIN_ITERATIONS 50
+
+/**
+ * function appending a v0.2 frame to the given byte stream
+ * @param stream: the stream to append to
+ * @param body: the body of the frame
+ * @param offset: the offset of the first body value
+ * @param command: the command byte
+ * @param unused: the reserved byte of the header
+ */
+inline void AppendFrame(std::vector<uint8_t>& stream, const std::vector<uint8_t>& body, int32_t offset, uint8_t command, uint8_t unused = 0)
+{
+    uint8_t header[10];
+    Convert::Int32ToBytes(body.size(), &header[0]);
+    Convert::Int32ToBytes(offset, &header[4]);
+    header[8] = command;
+    header[9] = unused;
+    stream.insert(stream.end(), header, header + sizeof(header));
+    stream.insert(stream.end(), body.begin(), body.end());
+}
+
+/**
+ * function appending a frame preceded by the sync word and followed by the CRCs to the given byte stream
+ * see ConfigurationOption::FRAMING; the parameters are the ones of AppendFrame()
+ */
+inline void AppendFramedFrame(std::vector<uint8_t>& stream, const std::vector<uint8_t>& body, int32_t offset, uint8_t command, uint8_t unused = 0)
+{
+    std::vector<uint8_t> frame;
+    AppendFrame(frame, body, offset, command, unused);
+    uint16_t headerCrc = Convert::Crc16(FRAME_CRC_INIT, frame.data(), FRAME_HEADER_SIZE);
+    uint16_t frameCrc = Convert::Crc16(headerCrc, body.data(), body.size());
+
+    stream.push_back(FRAME_SYNC_BYTE_1);
+    stream.push_back(FRAME_SYNC_BYTE_2);
+    stream.insert(stream.end(), frame.begin(), frame.begin() + FRAME_HEADER_SIZE);
+    stream.push_back(headerCrc >> 8);
+    stream.push_back(headerCrc & 0xFF);
+    stream.insert(stream.end(), body.begin(), body.end());
+    stream.push_back(frameCrc >> 8);
+    stream.push_back(frameCrc & 0xFF);
+}
+
+/**
+ * function building an RGB body with a pattern which changes with each led
+ */
+inline std::vector<uint8_t> PatternBody(int ledCount, int seed = 0)
+{
+    std::vector<uint8_t> body(ledCount * 3);
+    for(size_t i = 0; i < body.size(); i++)
+    {
+        body[i] = (uint8_t) (i * 7 + seed);
+    }
+    return body;
+}
+
+/**
+ * function appending a configuration option request to the given byte stream
+ * @param stream: the stream to append to
+ * @param option: the requested option, see ConfigurationOption
+ * @param value: the requested value
+ */
+inline void AppendOption(std::vector<uint8_t>& stream, uint8_t option, const std::vector<uint8_t>& value)
+{
+    stream.push_back(CONFIGURATION_OPTION_BYTE);
+    stream.push_back(option);
+    stream.push_back(value.size());
+    stream.insert(stream.end(), value.begin(), value.end());
+}
+
+/**
+ * function building the value of the COMMANDS option enabling the given commands
+ */
+inline std::vector<uint8_t> CommandsValue(std::vector<Command> commands)
+{
+    uint32_t mask = 0;
+    for(Command command : commands)
+    {
+        mask |= 1UL << command;
+    }
+    std::vector<uint8_t> value(4);
+    Convert::Int32ToBytes(mask, value.data());
+    return value;
+}
+
+/**
+ * function running the ALUP handshake against the given in-memory connection
+ * @param options: configuration option requests sent before the configuration is acknowledged
+ * @return: the result of Alup::Connect()
+ */
+template<class AlupT>
+int ConnectAlup(AlupT& alup, MemoryConnection& connection, const std::vector<uint8_t>& options = std::vector<uint8_t>())
+{
+    connection.Clear();
+    std::vector<uint8_t> answers = {CONNECTION_ACKNOWLEDGEMENT_BYTE};
+    answers.insert(answers.end(), options.begin(), options.end());
+    answers.push_back(CONFIGURATION_ACKNOWLEDGEMENT_BYTE);
+    connection.Feed(answers);
+    int result = alup.Connect(&connection, "Bench", "");
+    connection.Clear();
+    return result;
+}
+
+/**
+ * function calling the given function repeatedly until enough time has passed
+ * @param iteration: the function to measure
+ * @return: the average time of one call in nanoseconds
+ */
+template<typename F>
+double MeasureNanoseconds(F iteration)
+{
+    typedef std::chrono::steady_clock Clock;
+    long iterations = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    while(iterations < BENCH_MIN_ITERATIONS || elapsed < BENCH_MIN_SECONDS)
+    {
+        iteration();
+        iterations++;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    return elapsed * 1e9 / iterations;
+}
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * benchmark measuring the frame throughput of Alup::Run() on the host
+ * Each case replays the same full-strip frame from memory, so only the cost of reading,
+ * decoding and applying the frame is measured.
+ * It also checks that Run() never reads more than is available, also after a header with an invalid length.
+ */
+
+#include "BenchCommon.h"
+#include "SerialConnection.h"
+
+static const int ledCounts[] = {10, 100, 300, 1000, 3000, 10000};
+
+/**
+ * function measuring Run() for each strip length using the given connection
+ * @param name: the name of the connection shown in the output
+ * @param connection: the connection used by the device
+ * @param sent: the bytes sent by the device over the connection
+ * @param feed: function replacing the bytes received by the connection
+ * @param rewind: function replaying the received bytes
+ * @return: 1 if all frames were applied, else 0
+ */
+template<typename Feed, typename Rewind>
+int BenchConnection(const char* name, Connection& connection, std::vector<uint8_t>& sent, Feed feed, Rewind rewind)
+{
+    printf("%s\n", name);
+    printf("%8s %14s %14s %10s\n", "leds", "frames/s", "ns/frame", "ns/led");
+
+    for(int ledCount : ledCounts)
+    {
+        std::vector<CRGB> leds(ledCount);
+        Alup alup(leds.data(), ledCount, 0, 0);
+
+        uint8_t answers[] = {CONNECTION_ACKNOWLEDGEMENT_BYTE, CONFIGURATION_ACKNOWLEDGEMENT_BYTE};
+        feed(std::vector<uint8_t>(answers, answers + sizeof(answers)));
+        if(!alup.Connect(&connection, "Bench", ""))
+        {
+            printf("could not connect\n");
+            return 0;
+        }
+
+        std::vector<uint8_t> stream;
+        AppendFrame(stream, PatternBody(ledCount), 0, Command::NONE);
+        feed(stream);
+
+        double ns = MeasureNanoseconds([&]()
+        {
+            rewind();
+            sent.clear();
+            //the connection may deliver the frame in several parts
+            while(sent.empty())
+            {
+                alup.Run();
+            }
+        });
+
+        //make sure the frame was actually applied
+        if(leds[ledCount - 1] != CRGB(stream[stream.size() - 3], stream[stream.size() - 2], stream[stream.size() - 1]))
+        {
+            printf("frame was not applied\n");
+            return 0;
+        }
+
+        printf("%8d %14.0f %14.0f %10.2f\n", ledCount, 1e9 / ns, ns, ns / ledCount);
+    }
+    return 1;
+}
+
+/**
+ * function measuring Run() while frames arrive in small chunks and while nothing arrives
+ * @return: 1 if all frames were applied, else 0
+ */
+int BenchIncremental()
+{
+    const int ledCount = 1000;
+    const int chunkSize = 64;
+    std::vector<CRGB> leds(ledCount);
+    MemoryConnection connection;
+    Alup alup(leds.data(), ledCount, 0, 0);
+    if(!ConnectAlup(alup, connection))
+    {
+        printf("could not connect\n");
+        return 0;
+    }
+
+    //Run() without any received bytes
+    double idle = MeasureNanoseconds([&]()
+    {
+        alup.Run();
+    });
+
+    //Run() after each chunk of a frame arrived
+    std::vector<uint8_t> stream;
+    AppendFrame(stream, PatternBody(ledCount), 0, Command::NONE);
+    double chunked = MeasureNanoseconds([&]()
+    {
+        connection.Clear();
+        for(size_t i = 0; i < stream.size(); i += chunkSize)
+        {
+            size_t count = stream.size() - i < chunkSize ? stream.size() - i : chunkSize;
+            connection.Feed(&stream[i], count);
+            alup.Run();
+        }
+    });
+
+    if(connection.sent.size() != 1 || connection.sent[0] != FRAME_ACKNOWLEDGEMENT_BYTE
+        || leds[ledCount - 1] != CRGB(stream[stream.size() - 3], stream[stream.size() - 2], stream[stream.size() - 1]))
+    {
+        printf("chunked frame was not applied\n");
+        return 0;
+    }
+
+    printf("Run() without data: %.1f ns\n", idle);
+    printf("Run() per %d byte chunk of a %d led frame: %.1f ns, %.0f ns/frame\n", chunkSize, ledCount,
+        chunked / ((stream.size() + chunkSize - 1) / chunkSize), chunked);
+    return 1;
+}
+
+/**
+ * a connection counting the reads of more bytes than are available, which block a SerialConnection or UdpConnection
+ */
+class StrictConnection : public Connection
+{
+    public:
+        MemoryConnection memory;
+        int blockingReads = 0;
+
+        void Connect()
+        {
+            memory.Connect();
+        }
+
+        void Disconnect()
+        {
+            memory.Disconnect();
+        }
+
+        void Send(uint8_t* bytes, size_t length)
+        {
+            memory.Send(bytes, length);
+        }
+
+        int Read(uint8_t* buffer, size_t length)
+        {
+            if((int) length > memory.Available())
+            {
+                blockingReads++;
+            }
+            return memory.Read(buffer, length);
+        }
+
+        int Available()
+        {
+            return memory.Available();
+        }
+
+        bool isConnected()
+        {
+            return memory.isConnected();
+        }
+};
+
+/**
+ * function checking that a header with an invalid body size only drops the received bytes without blocking
+ * @return: 1 if Run() did not block and the next frame was applied, else 0
+ */
+int CheckInvalidLength()
+{
+    const int ledCount = 10;
+    std::vector<CRGB> leds(ledCount);
+    StrictConnection connection;
+    Alup alup(leds.data(), ledCount, 0, 0);
+    connection.memory.Feed({CONNECTION_ACKNOWLEDGEMENT_BYTE, CONFIGURATION_ACKNOWLEDGEMENT_BYTE});
+    if(!alup.Connect(&connection, "Bench", ""))
+    {
+        printf("could not connect\n");
+        return 0;
+    }
+    connection.memory.Clear();
+    connection.blockingReads = 0;
+
+    //a negative body size followed by bytes of unknown frames
+    std::vector<uint8_t> stream;
+    AppendFrame(stream, std::vector<uint8_t>(), 0, Command::NONE);
+    memset(stream.data(), 0xFF, 4);
+    stream.insert(stream.end(), 100, 0x42);
+    connection.memory.Feed(stream);
+    alup.Run();
+    if(connection.memory.Available() != 0 || connection.memory.sent != std::vector<uint8_t>({FRAME_ERROR_BYTE}))
+    {
+        printf("the stream was not flushed after an invalid body size\n");
+        return 0;
+    }
+
+    stream.clear();
+    AppendFrame(stream, PatternBody(ledCount), 0, Command::NONE);
+    connection.memory.Feed(stream);
+    alup.Run();
+    if(connection.blockingReads != 0 || connection.memory.sent.back() != FRAME_ACKNOWLEDGEMENT_BYTE)
+    {
+        printf("Run() read %d times more than was available\n", connection.blockingReads);
+        return 0;
+    }
+    return 1;
+}
+
+int main()
+{
+    MemoryConnection memory;
+    int ok = BenchConnection("MemoryConnection", memory, memory.sent,
+        [&](const std::vector<uint8_t>& bytes) { memory.Clear(); memory.Feed(bytes); },
+        [&]() { memory.Rewind(); });
+
+    SerialConnection serial(115200);
+    ok = ok && BenchConnection("SerialConnection", serial, Serial.sent,
+        [&](const std::vector<uint8_t>& bytes) { Serial.Clear(); Serial.Feed(bytes.data(), bytes.size()); },
+        [&]() { Serial.Rewind(); });
+
+    ok = ok && BenchIncremental();
+    ok = ok && CheckInvalidLength();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/**
+ * benchmark negotiating the baud rate of a simulated serial link (see ConfigurationOption::BAUD_RATE)
+ * The master connects to the device, switches to the highest rate both support which passes the verification
+ * burst and then sends full frames with stop-and-wait acknowledgements. The frame rate and the bytes/s are
+ * compared with a link staying at 115200 baud. A line which garbles rates above 1 Mbaud checks the fallback.
+ * The device connects on a second thread, see InteractiveMaster.
+ * Note: FastLED.show() takes no time here, so the gain is the one of the link
+ */
+
+#include "BenchCommon.h"
+#include "InteractiveMaster.h"
+#include "SerialConnection.h"
+
+#define LED_COUNT 1000
+#define FRAME_COUNT 20
+//the rate both sides use when connecting
+#define INITIAL_BAUD 115200
+//the time a device loop takes
+#define LOOP_TIME 50
+
+//the rates the USB serial adapter of the master supports
+static const std::vector<long> masterRates = {115200, 230400, 460800, 921600, 1000000, 2000000, 3000000};
+
+/**
+ * a case of the benchmark
+ */
+struct BaudCase
+{
+    const char* name;
+    bool negotiate;
+    //if the device offers the baud rate option
+    bool deviceRates;
+    //the highest rate the line transfers; 0 for any
+    long maxBaud;
+    //the rate which has to be negotiated
+    long expected;
+};
+
+static const BaudCase cases[] = {
+    {"fixed 115200 baud", false, true, 0, 115200},
+    {"negotiated", true, true, 0, 2000000},
+    {"negotiated, line <= 1 Mbaud", true, true, 1000000, 1000000},
+    {"negotiated, v0.2 device", true, false, 0, 115200},
+};
+
+/**
+ * function connecting to a device and measuring the frame rate afterwards
+ * @param bytesPerSecond: the bytes/s of frames and acknowledgements measured
+ * @return: the frames per second; 0 if the case failed
+ */
+double MeasureCase(const BaudCase& baudCase, double& bytesPerSecond)
+{
+    std::vector<CRGB> leds(LED_COUNT);
+    Alup alup(leds.data(), LED_COUNT, 0, 0);
+    LoopbackConnection connection;
+    LoopbackConnection masterConnection;
+    LoopbackConnection::Pair(connection, masterConnection);
+    for(LoopbackConnection* end : {&connection, &masterConnection})
+    {
+        end->SetInitialBaudRate(INITIAL_BAUD);
+        end->maxBaud = baudCase.maxBaud;
+    }
+    if(baudCase.deviceRates)
+    {
+        const long rates[] = SERIAL_CONNECTION_BAUD_RATES;
+        connection.baudRates.assign(std::begin(rates), std::end(rates));
+    }
+
+    InteractiveMaster master(masterConnection);
+    unsigned long start = HostClock::Micros();
+    int connected = master.Connect(alup, connection, [&](InteractiveMaster& negotiating) {
+        if(baudCase.negotiate)
+        {
+            negotiating.NegotiateBaudRate(masterRates);
+        }
+        return true;
+    });
+    double connectTime = (HostClock::Micros() - start) / 1000.0;
+    long baud = masterConnection.GetBaudRate();
+    if(!connected || baud != baudCase.expected || connection.GetBaudRate() != baud)
+    {
+        printf("%s: connecting failed, %ld baud instead of %ld\n", baudCase.name, baud, baudCase.expected);
+        return 0;
+    }
+
+    std::vector<uint8_t> stream;
+    AppendFrame(stream, PatternBody(LED_COUNT), 0, Command::NONE);
+    start = HostClock::Micros();
+    for(int i = 0; i < FRAME_COUNT; i++)
+    {
+        masterConnection.Send(stream.data(), stream.size());
+        while(masterConnection.Available() < 1)
+        {
+            alup.Run();
+            HostClock::Advance(LOOP_TIME);
+        }
+        uint8_t acknowledgement;
+        masterConnection.Read(&acknowledgement, 1);
+        if(acknowledgement != FRAME_ACKNOWLEDGEMENT_BYTE || memcmp(leds.data(), &stream[FRAME_HEADER_SIZE], LED_COUNT * 3) != 0)
+        {
+            printf("%s: frame %d was not applied\n", baudCase.name, i);
+            return 0;
+        }
+    }
+    double elapsed = (HostClock::Micros() - start) / 1e6;
+    bytesPerSecond = FRAME_COUNT * (stream.size() + 1) / elapsed;
+    printf("%-30s %9ld %12.1f %8.1f %12.0f", baudCase.name, baud, connectTime, FRAME_COUNT / elapsed, bytesPerSecond);
+    return FRAME_COUNT / elapsed;
+}
+
+int main()
+{
+    HostClock::Simulate(true);
+
+    printf("%d leds, stop-and-wait frames over a simulated serial link starting at %d baud\n", LED_COUNT, INITIAL_BAUD);
+    printf("%-30s %9s %12s %8s %12s %8s\n", "case", "baud", "connect ms", "fps", "bytes/s", "gain");
+    double fixedRate = 0;
+    for(const BaudCase& baudCase : cases)
+    {
+        double bytesPerSecond = 0;
+        double fps = MeasureCase(baudCase, bytesPerSecond);
+        if(fps == 0)
+        {
+            return 1;
+        }
+        if(fixedRate == 0)
+        {
+            fixedRate = bytesPerSecond;
+        }
+        printf(" %7.1fx\n", bytesPerSecond / fixedRate);
+    }
+    return 0;
+}
@@ -0,0 +1,264 @@
+/**
+ * benchmark letting a master pick the fastest mode a device supports from its capabilities
+ * (see ConfigurationOption::CAPABILITIES). The master asks for the capabilities while connecting, negotiates
+ * a pipeline window, the delta encoding if the device supports it and the highest baud rate, and streams an
+ * animation over a simulated serial link. The frame rate is compared with a v0.2 master which negotiates
+ * nothing: stop-and-wait, raw colors, 115200 baud.
+ */
+
+#include "BenchCommon.h"
+#include "InteractiveMaster.h"
+#include "MasterEncoder.h"
+#include "SerialConnection.h"
+
+#define LED_COUNT 300
+#define FRAME_COUNT 100
+//the rate both sides use when connecting
+#define INITIAL_BAUD 115200
+//the largest pipeline window the master uses
+#define MASTER_MAX_WINDOW 8
+//the time a device loop takes
+#define LOOP_TIME 10
+//the time it takes to show one WS2812 led
+#define WS2812_LED_DURATION 30
+//the length of the comet moving over the strip
+#define COMET_LENGTH 10
+
+//the rates the USB serial adapter of the master supports
+static const std::vector<long> masterRates = {115200, 230400, 460800, 921600, 1000000, 2000000, 3000000};
+
+/**
+ * the answer to the CAPABILITIES option
+ */
+struct Capabilities
+{
+    int32_t maxBodySize;
+    uint32_t freeMemory;
+    uint32_t commands;
+    uint32_t options;
+    int maxWindow;
+    uint32_t minFrameInterval;
+    std::vector<int32_t> channels;
+};
+
+/**
+ * function parsing the given answer to the CAPABILITIES option
+ * @return: false if the answer is too short
+ */
+bool ParseCapabilities(std::vector<uint8_t>& answer, Capabilities& capabilities)
+{
+    if(answer.size() < CAPABILITIES_SIZE || answer.size() < CAPABILITIES_SIZE + 4 * (size_t) answer[CAPABILITIES_SIZE - 1])
+    {
+        return false;
+    }
+    capabilities.maxBodySize = Convert::BytesToInt32(&answer[0]);
+    capabilities.freeMemory = Convert::BytesToInt32(&answer[4]);
+    capabilities.commands = Convert::BytesToInt32(&answer[8]);
+    capabilities.options = Convert::BytesToInt32(&answer[12]);
+    capabilities.maxWindow = answer[16];
+    capabilities.minFrameInterval = Convert::BytesToInt32(&answer[17]);
+    capabilities.channels.clear();
+    for(int i = 0; i < answer[CAPABILITIES_SIZE - 1]; i++)
+    {
+        capabilities.channels.push_back(Convert::BytesToInt32(&answer[CAPABILITIES_SIZE + 4 * i]));
+    }
+    return true;
+}
+
+/**
+ * the mode a master streams frames with
+ */
+struct Mode
+{
+    int window = 0;
+    bool delta = false;
+    long baud = INITIAL_BAUD;
+};
+
+/**
+ * function negotiating the fastest mode the device supports
+ * @param mode: the negotiated mode
+ * @return: false if the device answered wrong
+ */
+bool NegotiateFastestMode(InteractiveMaster& master, Mode& mode)
+{
+    std::vector<uint8_t> answer;
+    Capabilities capabilities;
+    if(!master.Option(ConfigurationOption::CAPABILITIES, std::vector<uint8_t>(), answer) || !ParseCapabilities(answer, capabilities)
+        || capabilities.maxBodySize < LED_COUNT * 3)
+    {
+        return false;
+    }
+    printf("  capabilities: max body %d bytes, commands 0x%08x, options 0x%02x, window %d, min frame interval %u us, %zu channel(s)\n",
+        capabilities.maxBodySize, capabilities.commands, capabilities.options, capabilities.maxWindow, capabilities.minFrameInterval, capabilities.channels.size());
+
+    if(capabilities.options & (1UL << ConfigurationOption::PIPELINE_WINDOW))
+    {
+        uint8_t window = capabilities.maxWindow < MASTER_MAX_WINDOW ? capabilities.maxWindow : MASTER_MAX_WINDOW;
+        if(!master.Option(ConfigurationOption::PIPELINE_WINDOW, std::vector<uint8_t>(1, window), answer) || answer.size() != 1)
+        {
+            return false;
+        }
+        mode.window = answer[0];
+    }
+    if(capabilities.commands & (1UL << Command::DELTA))
+    {
+        if(!master.Option(ConfigurationOption::COMMANDS, CommandsValue({Command::DELTA}), answer) || answer.size() != 4)
+        {
+            return false;
+        }
+        mode.delta = (Convert::BytesToInt32(answer.data()) & (1UL << Command::DELTA)) != 0;
+    }
+    if(capabilities.options & (1UL << ConfigurationOption::BAUD_RATE))
+    {
+        mode.baud = master.NegotiateBaudRate(masterRates);
+    }
+    return true;
+}
+
+/**
+ * function building frame i of the animation: a comet moving over a gradient
+ */
+std::vector<CRGB> AnimationFrame(int i)
+{
+    std::vector<CRGB> leds(LED_COUNT);
+    for(int led = 0; led < LED_COUNT; led++)
+    {
+        leds[led] = CRGB(led % 64, 0, 64 - led % 64);
+    }
+    for(int led = 0; led < COMET_LENGTH; led++)
+    {
+        leds[(i * 3 + led) % LED_COUNT] = CRGB(255, 255 - led * 20, 0);
+    }
+    return leds;
+}
+
+/**
+ * function connecting to a device and streaming the animation
+ * @param fastest: if the master negotiates the fastest mode, else it behaves like a v0.2 master
+ * @param mode: the mode used
+ * @return: the frame rate in frames/s; 0 if the device did not answer correctly
+ */
+template<class AlupT>
+double MeasureFrameRate(AlupT& alup, CRGB* leds, bool offerBaudRates, bool fastest, Mode& mode)
+{
+    LoopbackConnection connection;
+    LoopbackConnection masterConnection;
+    LoopbackConnection::Pair(connection, masterConnection);
+    connection.SetInitialBaudRate(INITIAL_BAUD);
+    masterConnection.SetInitialBaudRate(INITIAL_BAUD);
+    if(offerBaudRates)
+    {
+        const long rates[] = SERIAL_CONNECTION_BAUD_RATES;
+        connection.baudRates.assign(std::begin(rates), std::end(rates));
+    }
+
+    InteractiveMaster master(masterConnection);
+    mode = Mode();
+    int connected = master.Connect(alup, connection, [&](InteractiveMaster& negotiating) {
+        return !fastest || NegotiateFastestMode(negotiating, mode);
+    });
+    if(!connected)
+    {
+        return 0;
+    }
+
+    std::vector<CRGB> previous(leds, leds + LED_COUNT);
+    std::vector<CRGB> current;
+    int sent = 0;
+    int acknowledged = 0;
+    uint8_t lastAcknowledged = 255;
+    unsigned long start = HostClock::Micros();
+    while(acknowledged < FRAME_COUNT)
+    {
+        //send as many frames as the window allows
+        while(sent < FRAME_COUNT && sent - acknowledged < (mode.window > 0 ? mode.window : 1))
+        {
+            current = AnimationFrame(sent);
+            std::vector<uint8_t> stream;
+            if(mode.delta)
+            {
+                AppendFrame(stream, MasterEncoder::Delta(previous, current), 0, Command::DELTA, (uint8_t) sent);
+            }
+            else
+            {
+                AppendFrame(stream, MasterEncoder::Raw(current), 0, Command::NONE, (uint8_t) sent);
+            }
+            masterConnection.Send(stream.data(), stream.size());
+            previous = current;
+            sent++;
+        }
+
+        alup.Run();
+
+        //evaluate the acknowledgements
+        while(masterConnection.Available() > 0)
+        {
+            uint8_t answer;
+            masterConnection.Read(&answer, 1);
+            if(answer == FRAME_ACKNOWLEDGEMENT_BYTE && mode.window == 0)
+            {
+                acknowledged++;
+            }
+            else if(answer == FRAME_CUMULATIVE_ACKNOWLEDGEMENT_BYTE && mode.window > 0)
+            {
+                uint8_t sequence;
+                masterConnection.Read(&sequence, 1);
+                acknowledged += (uint8_t) (sequence - lastAcknowledged);
+                lastAcknowledged = sequence;
+            }
+            else
+            {
+                return 0;
+            }
+        }
+        HostClock::Advance(LOOP_TIME);
+    }
+    if(memcmp(leds, current.data(), LED_COUNT * 3) != 0)
+    {
+        return 0;
+    }
+    return FRAME_COUNT * 1e6 / (HostClock::Micros() - start);
+}
+
+/**
+ * function comparing a v0.2 master with a master picking the fastest mode for the given device
+ * @return: 1 if both streamed the animation correctly, else 0
+ */
+template<class AlupT>
+int MeasureDevice(const char* name, AlupT& alup, CRGB* leds, bool offerBaudRates)
+{
+    printf("%s\n", name);
+    Mode v02;
+    Mode picked;
+    double v02Rate = MeasureFrameRate(alup, leds, offerBaudRates, false, v02);
+    double pickedRate = MeasureFrameRate(alup, leds, offerBaudRates, true, picked);
+    if(v02Rate == 0 || pickedRate == 0)
+    {
+        printf("  the animation was not streamed correctly\n");
+        return 0;
+    }
+    printf("  %-8s %8s %8s %10s %10s\n", "master", "window", "delta", "baud", "fps");
+    printf("  %-8s %8d %8s %10ld %10.1f\n", "v0.2", v02.window, v02.delta ? "yes" : "no", v02.baud, v02Rate);
+    printf("  %-8s %8d %8s %10ld %10.1f  (%.1fx)\n", "fastest", picked.window, picked.delta ? "yes" : "no", picked.baud, pickedRate, pickedRate / v02Rate);
+    return 1;
+}
+
+static CRGB staticLeds[LED_COUNT];
+
+int main()
+{
+    HostClock::Simulate(true);
+    FastLED.showDuration = LED_COUNT * WS2812_LED_DURATION;
+
+    printf("%d leds, %d frames of a moving comet over a simulated serial link starting at %d baud\n", LED_COUNT, FRAME_COUNT, INITIAL_BAUD);
+    std::vector<CRGB> leds(LED_COUNT);
+    Alup alup(leds.data(), LED_COUNT, 0, 0);
+    int ok = MeasureDevice("Alup, serial connection with baud rates", alup, leds.data(), true);
+
+    StaticAlup<LoopbackConnection, LED_COUNT, 0> baseAlup(staticLeds, 0, 0);
+    ok = ok && MeasureDevice("StaticAlup with the base commands, fixed baud rate", baseAlup, staticLeds, false);
+
+    FastLED.showDuration = 0;
+    return ok ? 0 : 1;
+}
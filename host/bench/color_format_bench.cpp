@@ -0,0 +1,102 @@
+/**
+ * benchmark measuring the decode time of the RGB565 and RGB444 bodies compared to raw 24 bit colors
+ * For each format, it reports the bytes per frame, the decode time of Alup::Run(), the frame rate
+ * of a 2 Mbaud serial link and the cpu cycles per led a 240 MHz ESP32 can spend while keeping up with that link.
+ * The decoded leds are checked by encoding them again, with the body fed in small pieces
+ * so that colors are split between reads.
+ */
+
+#include "BenchCommon.h"
+#include "MasterEncoder.h"
+
+//the bytes/s of a 2 Mbaud serial link with 8N1
+#define SERIAL_BYTES_PER_SECOND 200000.0
+#define ESP32_CYCLES_PER_SECOND 240e6
+//the size of the pieces the body is fed in when checking the result
+#define PIECE_SIZE 5
+
+/**
+ * function checking that the given body is decoded correctly when it is received in small pieces
+ * @param alup: a device connected to connection
+ * @param leds: the leds of the device
+ * @param command: the command of the frame
+ * @param body: the body of the frame
+ * @param encode: the encoder of the body
+ * @return: true if the decoded leds encode to the body again
+ */
+bool CheckDecode(Alup& alup, MemoryConnection& connection, std::vector<CRGB>& leds, Command command,
+    const std::vector<uint8_t>& body, std::vector<uint8_t> (*encode)(const std::vector<CRGB>&))
+{
+    std::fill(leds.begin(), leds.end(), CRGB(0, 0, 0));
+    connection.Clear();
+    std::vector<uint8_t> stream;
+    AppendFrame(stream, body, 0, command);
+    for(size_t i = 0; i < stream.size(); i += PIECE_SIZE)
+    {
+        size_t end = i + PIECE_SIZE < stream.size() ? i + PIECE_SIZE : stream.size();
+        connection.Feed(std::vector<uint8_t>(stream.begin() + i, stream.begin() + end));
+        alup.Run();
+    }
+    return connection.sent == std::vector<uint8_t>({FRAME_ACKNOWLEDGEMENT_BYTE}) && encode(leds) == body;
+}
+
+int main()
+{
+    printf("fps of a 2 Mbaud link including the header and acknowledgement; cycles/led a 240 MHz ESP32 can spend at this fps\n");
+    printf("%6s %-8s %8s %12s %10s %16s\n", "leds", "format", "bytes", "decode ns", "fps", "ESP32 cycles/led");
+
+    for(int ledCount : {300, 1000, 4000})
+    {
+        std::vector<CRGB> colors(ledCount);
+        for(int i = 0; i < ledCount; i++)
+        {
+            colors[i] = CRGB(i * 7, 255 - i * 3, i * 13);
+        }
+
+        struct
+        {
+            const char* name;
+            Command command;
+            std::vector<uint8_t> (*encode)(const std::vector<CRGB>&);
+        } formats[] = {
+            {"raw", Command::NONE, MasterEncoder::Raw},
+            {"RGB565", Command::RGB565, MasterEncoder::Rgb565},
+            {"RGB444", Command::RGB444, MasterEncoder::Rgb444},
+        };
+
+        for(auto& format : formats)
+        {
+            std::vector<CRGB> leds(ledCount);
+            MemoryConnection connection;
+            Alup alup(leds.data(), ledCount, 0, 0);
+            std::vector<uint8_t> options;
+            AppendOption(options, ConfigurationOption::COMMANDS, CommandsValue({Command::RGB565, Command::RGB444}));
+            if(!ConnectAlup(alup, connection, options))
+            {
+                return 1;
+            }
+
+            std::vector<uint8_t> body = format.encode(colors);
+            if(!CheckDecode(alup, connection, leds, format.command, body, format.encode))
+            {
+                printf("%s was not decoded correctly\n", format.name);
+                return 1;
+            }
+
+            connection.Clear();
+            std::vector<uint8_t> stream;
+            AppendFrame(stream, body, 0, format.command);
+            connection.Feed(stream);
+            double ns = MeasureNanoseconds([&]()
+            {
+                connection.Rewind();
+                alup.Run();
+            });
+
+            double fps = SERIAL_BYTES_PER_SECOND / (FRAME_HEADER_SIZE + body.size() + 1);
+            double cycles = ESP32_CYCLES_PER_SECOND / (fps * ledCount);
+            printf("%6d %-8s %8zu %12.0f %10.1f %16.0f\n", ledCount, format.name, body.size(), ns, fps, cycles);
+        }
+    }
+    return 0;
+}
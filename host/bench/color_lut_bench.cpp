@@ -0,0 +1,283 @@
+/**
+ * benchmark measuring the decode time of frames with color lookup tables (COLOR_LUT) compared to plain colors
+ * For raw, RGB565 and 8 bit palette bodies, it reports the time of Alup::Run() without tables and with a
+ * gamma table, the difference, and the difference relative to the time the frame takes on a 2 Mbaud link.
+ * Note: raw colors are read with one memcpy() on the host, which a table lookup per byte can not keep up with;
+ * on a device the link takes far longer than either. The decoded leds are checked against the gamma corrected colors, with the
+ * body fed in small pieces so that colors are split between reads.
+ * Delta frames have to be rejected while tables are used, and tables of a frame with a wrong CRC must not be used.
+ * It also compares the bytes a master sends for a brightness fade: the whole strip per step when the master
+ * scales the colors itself, or one COLOR_LUT frame without tables per step.
+ */
+
+#include "BenchCommon.h"
+#include "MasterEncoder.h"
+#include <math.h>
+
+//the size of the pieces the body is fed in when checking the result
+#define PIECE_SIZE 5
+//the gamma of the table
+#define GAMMA 2.2
+//the number of steps of the brightness fade
+#define FADE_STEPS 64
+//the offset of COLOR_LUT frames keeping the brightness
+#define KEEP_BRIGHTNESS 256
+//the time it takes to show one WS2812 led
+#define WS2812_LED_DURATION 30
+//the bytes/s of a 2 Mbaud serial link with 8N1
+#define SERIAL_BYTES_PER_SECOND 200000.0
+
+/**
+ * function building a gamma table
+ */
+std::vector<uint8_t> GammaTable()
+{
+    std::vector<uint8_t> table(COLOR_LUT_SIZE);
+    for(int i = 0; i < COLOR_LUT_SIZE; i++)
+    {
+        table[i] = (uint8_t) (pow(i / 255.0, GAMMA) * 255 + 0.5);
+    }
+    return table;
+}
+
+/**
+ * function encoding the given colors as 8 bit palette indices, using the palette built by PaletteBody()
+ */
+std::vector<uint8_t> Palette8(const std::vector<CRGB>& colors)
+{
+    std::vector<uint8_t> body(colors.size());
+    for(size_t i = 0; i < colors.size(); i++)
+    {
+        body[i] = i % PALETTE_SIZE;
+    }
+    return body;
+}
+
+/**
+ * function building the palette upload body of the colors, which repeat every PALETTE_SIZE leds
+ */
+std::vector<uint8_t> PaletteBody(const std::vector<CRGB>& colors)
+{
+    std::vector<CRGB> entries(PALETTE_SIZE);
+    for(int i = 0; i < PALETTE_SIZE && i < (int) colors.size(); i++)
+    {
+        entries[i] = colors[i];
+    }
+    return MasterEncoder::Raw(entries);
+}
+
+/**
+ * function sending the given frame to the device in small pieces
+ * @return: true if the device acknowledged it
+ */
+bool SendInPieces(Alup& alup, MemoryConnection& connection, const std::vector<uint8_t>& body, int32_t offset, Command command)
+{
+    connection.Clear();
+    std::vector<uint8_t> stream;
+    stream.reserve(FRAME_HEADER_SIZE + body.size());
+    AppendFrame(stream, body, offset, command);
+    for(size_t i = 0; i < stream.size(); i += PIECE_SIZE)
+    {
+        size_t end = i + PIECE_SIZE < stream.size() ? i + PIECE_SIZE : stream.size();
+        connection.Feed(std::vector<uint8_t>(stream.begin() + i, stream.begin() + end));
+        alup.Run();
+    }
+    return connection.sent == std::vector<uint8_t>({FRAME_ACKNOWLEDGEMENT_BYTE});
+}
+
+/**
+ * function checking that DELTA frames are answered with a frame error while tables are used,
+ * as the leds hold corrected colors
+ * @return: true if the frame was rejected and the leds were not changed
+ */
+bool RejectsDelta(const std::vector<uint8_t>& gamma)
+{
+    std::vector<CRGB> leds(1, CRGB(0, 0, 0));
+    MemoryConnection connection;
+    Alup alup(leds.data(), 1, 0, 0);
+    std::vector<uint8_t> options;
+    AppendOption(options, ConfigurationOption::COMMANDS, CommandsValue({Command::DELTA, Command::COLOR_LUT}));
+    if(!ConnectAlup(alup, connection, options) || !SendInPieces(alup, connection, gamma, KEEP_BRIGHTNESS, Command::COLOR_LUT))
+    {
+        return false;
+    }
+    //skip no led and change one
+    std::vector<uint8_t> span = {0, 0, 0, 1, 10, 20, 30};
+    SendInPieces(alup, connection, span, 0, Command::DELTA);
+    return connection.sent == std::vector<uint8_t>({FRAME_ERROR_BYTE}) && leds[0] == CRGB(0, 0, 0);
+}
+
+/**
+ * function checking that tables of a frame with a corrupted body are not used
+ * Frames are framed by a sync word and CRCs, see ConfigurationOption::FRAMING.
+ * @return: true if the frame was rejected and the colors of the next frame are corrected by the previous tables
+ */
+bool KeepsTablesOfCorruptedFrame(const std::vector<uint8_t>& gamma)
+{
+    std::vector<CRGB> leds(1, CRGB(0, 0, 0));
+    MemoryConnection connection;
+    Alup alup(leds.data(), 1, 0, 0);
+    std::vector<uint8_t> options;
+    AppendOption(options, ConfigurationOption::COMMANDS, CommandsValue({Command::COLOR_LUT}));
+    AppendOption(options, ConfigurationOption::FRAMING, std::vector<uint8_t>(1, 1));
+    if(!ConnectAlup(alup, connection, options))
+    {
+        return false;
+    }
+    std::vector<uint8_t> identity(COLOR_LUT_SIZE);
+    for(int i = 0; i < COLOR_LUT_SIZE; i++)
+    {
+        identity[i] = i;
+    }
+    std::vector<uint8_t> stream;
+    AppendFramedFrame(stream, gamma, KEEP_BRIGHTNESS, Command::COLOR_LUT);
+    size_t corrupted = stream.size();
+    AppendFramedFrame(stream, identity, KEEP_BRIGHTNESS, Command::COLOR_LUT);
+    //a byte of the body of the second tables
+    stream[corrupted + FRAME_SYNC_SIZE + FRAME_HEADER_SIZE + FRAME_CRC_SIZE + 100] ^= 0xFF;
+    AppendFramedFrame(stream, {10, 20, 30}, 0, Command::NONE);
+    connection.Clear();
+    connection.Feed(stream);
+    alup.Run();
+    std::vector<uint8_t> answers = {FRAME_ACKNOWLEDGEMENT_BYTE, FRAME_ERROR_BYTE, FRAME_ACKNOWLEDGEMENT_BYTE};
+    return connection.sent == answers && leds[0] == CRGB(gamma[10], gamma[20], gamma[30]);
+}
+
+int main()
+{
+    std::vector<uint8_t> gamma = GammaTable();
+    printf("decode time of Alup::Run() per frame, gamma %.1f table for red, green and blue\n", GAMMA);
+    printf("%6s %-10s %14s %14s %10s %14s\n", "leds", "format", "plain ns", "table ns", "overhead", "of 2 Mbaud");
+
+    for(int ledCount : {300, 1000, 4000})
+    {
+        std::vector<CRGB> colors(ledCount);
+        std::vector<CRGB> corrected(ledCount);
+        for(int i = 0; i < ledCount; i++)
+        {
+            colors[i] = CRGB(i * 7, 255 - i * 3, i * 13);
+            corrected[i] = CRGB(gamma[colors[i].r], gamma[colors[i].g], gamma[colors[i].b]);
+        }
+
+        struct
+        {
+            const char* name;
+            Command command;
+            std::vector<uint8_t> (*encode)(const std::vector<CRGB>&);
+            //the colors the body encodes exactly
+            bool exact;
+        } formats[] = {
+            {"raw", Command::NONE, MasterEncoder::Raw, true},
+            {"RGB565", Command::RGB565, MasterEncoder::Rgb565, false},
+            {"palette 8", Command::PALETTE_8, Palette8, false},
+        };
+
+        for(auto& format : formats)
+        {
+            std::vector<CRGB> leds(ledCount);
+            MemoryConnection connection;
+            Alup alup(leds.data(), ledCount, 0, 0);
+            std::vector<uint8_t> options;
+            AppendOption(options, ConfigurationOption::COMMANDS, CommandsValue({Command::RGB565, Command::PALETTE_UPLOAD, Command::PALETTE_8, Command::COLOR_LUT}));
+            if(!ConnectAlup(alup, connection, options) || !SendInPieces(alup, connection, PaletteBody(colors), 0, Command::PALETTE_UPLOAD))
+            {
+                return 1;
+            }
+
+            std::vector<uint8_t> body = format.encode(colors);
+            double ns[2];
+            for(int table = 0; table < 2; table++)
+            {
+                if(table == 1 && !SendInPieces(alup, connection, gamma, KEEP_BRIGHTNESS, Command::COLOR_LUT))
+                {
+                    printf("the tables were not accepted\n");
+                    return 1;
+                }
+                std::fill(leds.begin(), leds.end(), CRGB(0, 0, 0));
+                if(!SendInPieces(alup, connection, body, 0, format.command))
+                {
+                    printf("%s was not acknowledged\n", format.name);
+                    return 1;
+                }
+                connection.Clear();
+                std::vector<uint8_t> stream;
+                stream.reserve(FRAME_HEADER_SIZE + body.size());
+                AppendFrame(stream, body, 0, format.command);
+                connection.Feed(stream);
+                ns[table] = MeasureNanoseconds([&]()
+                {
+                    connection.Rewind();
+                    alup.Run();
+                });
+
+                if(table == 0 && !format.exact)
+                {
+                    //the palette repeats every PALETTE_SIZE leds and RGB565 loses precision, so the colors
+                    //decoded without tables are corrected instead
+                    for(int i = 0; i < ledCount; i++)
+                    {
+                        corrected[i] = CRGB(gamma[leds[i].r], gamma[leds[i].g], gamma[leds[i].b]);
+                    }
+                }
+                const std::vector<CRGB>& expected = table == 1 ? corrected : (format.exact ? colors : leds);
+                if(memcmp((void*) leds.data(), expected.data(), ledCount * sizeof(CRGB)) != 0)
+                {
+                    printf("%s was not decoded correctly\n", format.name);
+                    return 1;
+                }
+            }
+            double linkNs = (FRAME_HEADER_SIZE + body.size() + 1) * 1e9 / SERIAL_BYTES_PER_SECOND;
+            printf("%6d %-10s %14.0f %14.0f %9.1f%% %13.3f%%\n", ledCount, format.name, ns[0], ns[1], (ns[1] - ns[0]) * 100 / ns[0], (ns[1] - ns[0]) * 100 / linkNs);
+
+            //restore the colors of the exact format for the next one
+            for(int i = 0; i < ledCount; i++)
+            {
+                corrected[i] = CRGB(gamma[colors[i].r], gamma[colors[i].g], gamma[colors[i].b]);
+            }
+        }
+    }
+
+    if(!RejectsDelta(gamma))
+    {
+        printf("a delta frame was applied to corrected colors\n");
+        return 1;
+    }
+    if(!KeepsTablesOfCorruptedFrame(gamma))
+    {
+        printf("the tables of a corrupted frame were used\n");
+        return 1;
+    }
+
+    //fade a strip of 1000 WS2812 leds to black; each step is shown once the previous show is done
+    HostClock::Simulate(true);
+    int ledCount = 1000;
+    FastLED.showDuration = ledCount * WS2812_LED_DURATION;
+    std::vector<CRGB> leds(ledCount);
+    MemoryConnection connection;
+    Alup alup(leds.data(), ledCount, 0, 0);
+    std::vector<uint8_t> options;
+    AppendOption(options, ConfigurationOption::COMMANDS, CommandsValue({Command::COLOR_LUT}));
+    if(!ConnectAlup(alup, connection, options) || !SendInPieces(alup, connection, PatternBody(ledCount), 0, Command::NONE))
+    {
+        return 1;
+    }
+    unsigned long shows = FastLED.showCount;
+    for(int step = FADE_STEPS - 1; step >= 0; step--)
+    {
+        uint8_t brightness = step * 255 / (FADE_STEPS - 1);
+        HostClock::Advance(1000000 / ALUP_CLOCKLESS_MAX_REFRESH_RATE);
+        if(!SendInPieces(alup, connection, std::vector<uint8_t>(), brightness, Command::COLOR_LUT) || FastLED.getBrightness() != brightness)
+        {
+            printf("the brightness was not changed\n");
+            return 1;
+        }
+    }
+    if(FastLED.showCount - shows != FADE_STEPS - 1 || memcmp((void*) leds.data(), PatternBody(ledCount).data(), ledCount * 3) != 0)
+    {
+        printf("the fade was not shown\n");
+        return 1;
+    }
+    printf("\nfade of %d leds in %d steps: %d bytes resending the strip, %d bytes of COLOR_LUT frames\n", ledCount, FADE_STEPS,
+        FADE_STEPS * (FRAME_HEADER_SIZE + ledCount * 3), FADE_STEPS * FRAME_HEADER_SIZE);
+    return 0;
+}
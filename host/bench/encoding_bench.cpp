@@ -0,0 +1,175 @@
+/**
+ * benchmark comparing the raw v0.2 body with the RUN_LENGTH, DELTA and palette encodings
+ * For each scene, it reports the bytes on the wire per frame, the decode time of Alup::Run()
+ * and the resulting frame rate of a 115200 baud serial link.
+ * Note: the palette is uploaded once before the frames, so its size is not included
+ */
+
+#include "BenchCommon.h"
+#include "MasterEncoder.h"
+
+#define LED_COUNT 300
+//the bytes/s of a 115200 baud serial link with 8N1
+#define SERIAL_BYTES_PER_SECOND 11520.0
+
+/**
+ * a pair of consecutive frames of a scene
+ */
+struct Scene
+{
+    const char* name;
+    std::vector<CRGB> previous;
+    std::vector<CRGB> current;
+};
+
+/**
+ * function building the scenes measured
+ */
+std::vector<Scene> BuildScenes()
+{
+    std::vector<Scene> scenes;
+    srand(1);
+
+    //the whole strip in one color, fading
+    Scene solid = {"solid fill", std::vector<CRGB>(LED_COUNT, CRGB(255, 120, 20)), std::vector<CRGB>(LED_COUNT, CRGB(250, 118, 20))};
+    scenes.push_back(solid);
+
+    //a few zones of one color each, one of them changing
+    Scene zones = {"ambient zones", std::vector<CRGB>(LED_COUNT), std::vector<CRGB>(LED_COUNT)};
+    for(int i = 0; i < LED_COUNT; i++)
+    {
+        int zone = i * 6 / LED_COUNT;
+        zones.previous[i] = CRGB(40 * zone, 255 - 40 * zone, 80);
+        zones.current[i] = zone == 2 ? CRGB(40 * zone + 3, 250 - 40 * zone, 80) : zones.previous[i];
+    }
+    scenes.push_back(zones);
+
+    //random colors of which 2% change per frame
+    Scene twinkle = {"sparse twinkle", std::vector<CRGB>(LED_COUNT), std::vector<CRGB>(LED_COUNT)};
+    for(int i = 0; i < LED_COUNT; i++)
+    {
+        twinkle.previous[i] = CRGB(rand(), rand(), rand());
+        twinkle.current[i] = rand() % 50 == 0 ? CRGB(rand(), rand(), rand()) : twinkle.previous[i];
+    }
+    scenes.push_back(twinkle);
+
+    //an effect using a palette of 16 colors, moving along the strip
+    Scene effect = {"16 color effect", std::vector<CRGB>(LED_COUNT), std::vector<CRGB>(LED_COUNT)};
+    for(int i = 0; i < LED_COUNT; i++)
+    {
+        effect.previous[i] = CRGB((i % 16) * 16, 255 - (i % 16) * 16, 40);
+        effect.current[i] = CRGB(((i + 1) % 16) * 16, 255 - ((i + 1) % 16) * 16, 40);
+    }
+    scenes.push_back(effect);
+
+    //a different color on each led, all changing
+    Scene gradient = {"moving gradient", std::vector<CRGB>(LED_COUNT), std::vector<CRGB>(LED_COUNT)};
+    for(int i = 0; i < LED_COUNT; i++)
+    {
+        gradient.previous[i] = CRGB(i, 255 - i / 2, i * 3);
+        gradient.current[i] = CRGB(i + 1, 255 - (i + 1) / 2, (i + 1) * 3);
+    }
+    scenes.push_back(gradient);
+
+    return scenes;
+}
+
+/**
+ * function measuring the decode time of the given body
+ * @param command: the command of the frame
+ * @param body: the body of the frame
+ * @param scene: the scene of which the current frame is encoded
+ * @param palette: the palette uploaded before the frames
+ * @return: the time per frame in ns; 0 if the frame was not decoded correctly
+ */
+double MeasureDecode(Command command, const std::vector<uint8_t>& body, const Scene& scene, const std::vector<CRGB>& palette)
+{
+    std::vector<CRGB> leds(scene.previous);
+    MemoryConnection connection;
+    Alup alup(leds.data(), LED_COUNT, 0, 0);
+    std::vector<uint8_t> options;
+    AppendOption(options, ConfigurationOption::COMMANDS, CommandsValue({Command::RUN_LENGTH, Command::DELTA,
+        Command::PALETTE_UPLOAD, Command::PALETTE_8, Command::PALETTE_4}));
+    if(!ConnectAlup(alup, connection, options))
+    {
+        return 0;
+    }
+
+    std::vector<uint8_t> upload;
+    AppendFrame(upload, MasterEncoder::Raw(palette), 0, Command::PALETTE_UPLOAD);
+    connection.Feed(upload);
+    alup.Run();
+    if(connection.sent != std::vector<uint8_t>({FRAME_ACKNOWLEDGEMENT_BYTE}))
+    {
+        return 0;
+    }
+    connection.Clear();
+
+    //a delta applied twice restores the previous frame, so two frames are applied per iteration
+    std::vector<uint8_t> stream;
+    AppendFrame(stream, body, 0, command);
+    AppendFrame(stream, body, 0, command);
+    connection.Feed(stream);
+    double ns = MeasureNanoseconds([&]()
+    {
+        connection.Rewind();
+        alup.Run();
+    });
+
+    //apply the frame once more and check the result
+    connection.Clear();
+    std::vector<uint8_t> single;
+    AppendFrame(single, body, 0, command);
+    connection.Feed(single);
+    alup.Run();
+    if(leds != scene.current)
+    {
+        return 0;
+    }
+    return ns / 2;
+}
+
+int main()
+{
+    printf("%d leds; fps of a 115200 baud link including the header and acknowledgement\n", LED_COUNT);
+    printf("%-16s %-10s %10s %12s %10s\n", "scene", "encoding", "bytes", "decode ns", "fps");
+
+    for(const Scene& scene : BuildScenes())
+    {
+        std::vector<CRGB> palette;
+        bool palette8 = MasterEncoder::BuildPalette(scene.current, 256, palette);
+        bool palette4 = palette.size() <= 16;
+
+        struct
+        {
+            const char* name;
+            Command command;
+            std::vector<uint8_t> body;
+            bool usable;
+        } encodings[] = {
+            {"raw", Command::NONE, MasterEncoder::Raw(scene.current), true},
+            {"run length", Command::RUN_LENGTH, MasterEncoder::RunLength(scene.current), true},
+            {"delta", Command::DELTA, MasterEncoder::Delta(scene.previous, scene.current), true},
+            {"palette 8", Command::PALETTE_8, palette8 ? MasterEncoder::Palette8(scene.current, palette) : std::vector<uint8_t>(), palette8},
+            {"palette 4", Command::PALETTE_4, palette8 && palette4 ? MasterEncoder::Palette4(scene.current, palette) : std::vector<uint8_t>(), palette8 && palette4},
+        };
+
+        for(auto& encoding : encodings)
+        {
+            if(!encoding.usable)
+            {
+                printf("%-16s %-10s %10s\n", scene.name, encoding.name, "too many colors");
+                continue;
+            }
+            double ns = MeasureDecode(encoding.command, encoding.body, scene, palette);
+            if(ns == 0)
+            {
+                printf("%s was not decoded correctly\n", encoding.name);
+                return 1;
+            }
+            double wireBytes = FRAME_HEADER_SIZE + encoding.body.size() + 1;
+            printf("%-16s %-10s %10zu %12.0f %10.1f\n", scene.name, encoding.name, encoding.body.size(), ns, SERIAL_BYTES_PER_SECOND / wireBytes);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,167 @@
+/**
+ * benchmark streaming frames of a large strip over a lossy datagram link, see ConfigurationOption::FRAGMENTATION
+ * A frame does not fit into one datagram, so a v0.2 master splits the byte stream into datagrams of the
+ * maximum size; a lost or reordered datagram shifts every byte after it and the device shows garbage until
+ * it finds the start of a frame again by chance. A master using fragmentation sends each frame in fragments
+ * with a frame id and fragment index; the device drops incomplete frames and shows the newest complete one.
+ * It reports the frames shown correctly, the frames with wrong colors and the longest run of frames missed.
+ */
+
+#include "BenchCommon.h"
+#include "DatagramConnection.h"
+#include <random>
+
+#define LED_COUNT 1000
+#define FRAME_COUNT 2000
+//the payload of a datagram which is not fragmented by IP on an ethernet/WiFi MTU of 1500 bytes
+#define DATAGRAM_SIZE 1472
+//the probability that a datagram is delivered after the next one
+#define REORDER_RATE 0.005
+
+/**
+ * function splitting the byte stream of a frame into datagrams like a v0.2 master
+ */
+std::vector<std::vector<uint8_t>> SplitStream(const std::vector<uint8_t>& stream)
+{
+    std::vector<std::vector<uint8_t>> datagrams;
+    for(size_t start = 0; start < stream.size(); start += DATAGRAM_SIZE)
+    {
+        size_t end = start + DATAGRAM_SIZE < stream.size() ? start + DATAGRAM_SIZE : stream.size();
+        datagrams.push_back(std::vector<uint8_t>(stream.begin() + start, stream.begin() + end));
+    }
+    return datagrams;
+}
+
+/**
+ * function splitting the byte stream of a frame into fragments of equal size, see FrameReassembler
+ */
+std::vector<std::vector<uint8_t>> Fragment(const std::vector<uint8_t>& stream, uint16_t frameId)
+{
+    const int payload = DATAGRAM_SIZE - FRAGMENT_HEADER_SIZE;
+    int count = (stream.size() + payload - 1) / payload;
+    int fragmentSize = (stream.size() + count - 1) / count;
+    std::vector<std::vector<uint8_t>> datagrams;
+    for(int i = 0; i < count; i++)
+    {
+        size_t start = i * fragmentSize;
+        size_t end = start + fragmentSize < stream.size() ? start + fragmentSize : stream.size();
+        std::vector<uint8_t> datagram = {(uint8_t) (frameId >> 8), (uint8_t) frameId, (uint8_t) i, (uint8_t) count,
+            (uint8_t) (stream.size() >> 8), (uint8_t) stream.size()};
+        datagram.insert(datagram.end(), stream.begin() + start, stream.begin() + end);
+        datagrams.push_back(datagram);
+    }
+    return datagrams;
+}
+
+struct Result
+{
+    int correct = 0;
+    int corrupted = 0;
+    int longestMiss = 0;
+    uint32_t dropped = 0;
+};
+
+/**
+ * function streaming the frames over a link losing the given share of datagrams
+ * @param fragmentation: if the master negotiates fragmentation, else it behaves like a v0.2 master
+ * @return: false if the device did not accept fragmentation
+ */
+bool Stream(bool fragmentation, double lossRate, Result& result)
+{
+    std::vector<CRGB> leds(LED_COUNT);
+    Alup alup(leds.data(), LED_COUNT, 0, 0);
+    DatagramConnection connection;
+    std::vector<uint8_t> answers = {CONNECTION_ACKNOWLEDGEMENT_BYTE};
+    if(fragmentation)
+    {
+        AppendOption(answers, ConfigurationOption::FRAGMENTATION, std::vector<uint8_t>(1, 1));
+    }
+    answers.push_back(CONFIGURATION_ACKNOWLEDGEMENT_BYTE);
+    connection.Feed(answers);
+    if(!alup.Connect(&connection, "Bench", "") || connection.fragmentation != fragmentation)
+    {
+        return false;
+    }
+
+    //the same datagrams are lost in both modes as long as they send the same number per frame
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> chance(0, 1);
+    std::vector<uint8_t> previous(leds.size() * 3, 0);
+    int miss = 0;
+    for(int i = 0; i < FRAME_COUNT; i++)
+    {
+        std::vector<uint8_t> body = PatternBody(LED_COUNT, i);
+        std::vector<uint8_t> stream;
+        stream.reserve(FRAME_HEADER_SIZE + body.size());
+        AppendFrame(stream, body, 0, Command::NONE, (uint8_t) i);
+        std::vector<std::vector<uint8_t>> datagrams = fragmentation ? Fragment(stream, i) : SplitStream(stream);
+        for(size_t d = 0; d + 1 < datagrams.size(); d++)
+        {
+            if(chance(random) < REORDER_RATE)
+            {
+                std::swap(datagrams[d], datagrams[d + 1]);
+            }
+        }
+        for(std::vector<uint8_t>& datagram : datagrams)
+        {
+            if(chance(random) >= lossRate)
+            {
+                connection.Feed(datagram);
+            }
+        }
+
+        //the device loop parses one datagram at a time without fragmentation
+        do
+        {
+            alup.Run();
+        }
+        while(connection.Available() > 0);
+        connection.sent.clear();
+        if(memcmp((void*) leds.data(), body.data(), body.size()) == 0)
+        {
+            result.correct++;
+            miss = 0;
+            previous = body;
+            continue;
+        }
+        miss++;
+        result.longestMiss = miss > result.longestMiss ? miss : result.longestMiss;
+        if(memcmp((void*) leds.data(), previous.data(), previous.size()) != 0)
+        {
+            //neither the frame nor the last one shown
+            result.corrupted++;
+            memcpy(previous.data(), (void*) leds.data(), previous.size());
+        }
+    }
+    result.dropped = connection.reassembler.droppedFrames;
+    return true;
+}
+
+int main()
+{
+    printf("%d leds (%d byte frames), %d frames in datagrams of at most %d bytes, %.1f%% reordered\n",
+        LED_COUNT, LED_COUNT * 3 + FRAME_HEADER_SIZE, FRAME_COUNT, DATAGRAM_SIZE, REORDER_RATE * 100);
+    printf("%-14s %6s %10s %10s %12s %10s\n", "master", "loss", "correct", "corrupted", "longest miss", "dropped");
+    for(double lossRate : {0.0, 0.01, 0.05})
+    {
+        Result results[2];
+        for(bool fragmentation : {false, true})
+        {
+            Result& result = results[fragmentation];
+            if(!Stream(fragmentation, lossRate, result))
+            {
+                printf("the device did not accept fragmentation\n");
+                return 1;
+            }
+            printf("%-14s %5.0f%% %9.1f%% %10d %12d %10u\n", fragmentation ? "fragmentation" : "v0.2", lossRate * 100,
+                result.correct * 100.0 / FRAME_COUNT, result.corrupted, result.longestMiss, result.dropped);
+        }
+        //fragmented frames are either shown correctly or dropped, and never stall the stream
+        if(results[1].corrupted != 0 || results[1].correct < results[0].correct || (lossRate == 0 && results[1].correct != FRAME_COUNT))
+        {
+            printf("fragmented frames were not shown correctly\n");
+            return 1;
+        }
+    }
+    return 0;
+}
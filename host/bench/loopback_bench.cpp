@@ -0,0 +1,236 @@
+/**
+ * benchmark streaming frames end-to-end over real connections of this machine: UDP and TCP sockets on the
+ * loopback interface and a pseudo-terminal at a simulated baud rate. The device runs Alup on its own thread
+ * like alup_device; the master connects, negotiates a pipeline window or not and streams raw frames.
+ * It reports the frame rate and the time from sending a frame until its acknowledgement arrived, measured in
+ * real time, and checks that the device shows the last frame.
+ */
+
+#include "BenchCommon.h"
+#include "PtyConnection.h"
+#include "SocketConnection.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#define LED_COUNT 300
+#define FRAME_COUNT 100
+//the window negotiated by a pipelining master
+#define MASTER_WINDOW 8
+//the time the master waits for an answer in ms
+#define MASTER_TIMEOUT 2000
+//the ports used on the loopback interface
+#define DEVICE_PORT 25012
+#define MASTER_PORT 25013
+#define PTY_BAUD 1000000
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * function reading the given number of bytes from the given connection
+ * @return: false if they were not received within MASTER_TIMEOUT
+ */
+bool ReadWithin(Connection& link, uint8_t* buffer, int length)
+{
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(MASTER_TIMEOUT);
+    int count = 0;
+    while(count < length)
+    {
+        int available = link.Available();
+        if(available > 0)
+        {
+            count += link.Read(&buffer[count], std::min(available, length - count));
+            continue;
+        }
+        if(Clock::now() > deadline || !link.isConnected())
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    return true;
+}
+
+/**
+ * function reading bytes until the given one was read
+ * @return: false if it was not received in time
+ */
+bool ReadUntil(Connection& link, uint8_t expected)
+{
+    uint8_t byte = ~expected;
+    while(byte != expected)
+    {
+        if(!ReadWithin(link, &byte, 1))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * function answering the connection request, reading the configuration and negotiating the pipeline window
+ * @param window: the window to negotiate; 0 for stop-and-wait
+ * @return: false if the device did not answer
+ */
+bool MasterConnect(Connection& link, int window)
+{
+    if(!ReadUntil(link, CONNECTION_REQUEST_BYTE))
+    {
+        return false;
+    }
+    uint8_t acknowledgement = CONNECTION_ACKNOWLEDGEMENT_BYTE;
+    link.Send(&acknowledgement, 1);
+
+    //protocol version, device name, led count, data pin, clock pin, extra values
+    uint8_t values[12];
+    if(!ReadUntil(link, CONFIGURATION_START_BYTE) || !ReadUntil(link, 0) || !ReadUntil(link, 0) || !ReadWithin(link, values, 12)
+        || !ReadUntil(link, 0) || Convert::BytesToInt32(values) != LED_COUNT)
+    {
+        return false;
+    }
+
+    if(window > 0)
+    {
+        std::vector<uint8_t> request;
+        AppendOption(request, ConfigurationOption::PIPELINE_WINDOW, std::vector<uint8_t>(1, window));
+        link.Send(request.data(), request.size());
+        uint8_t answer[4];
+        if(!ReadWithin(link, answer, 4) || answer[0] != CONFIGURATION_OPTION_BYTE || answer[3] != window)
+        {
+            return false;
+        }
+    }
+    uint8_t configurationAcknowledgement = CONFIGURATION_ACKNOWLEDGEMENT_BYTE;
+    link.Send(&configurationAcknowledgement, 1);
+    return true;
+}
+
+/**
+ * function streaming the frames
+ * @param latencies: the time from sending each frame until its acknowledgement in microseconds
+ * @return: the time in seconds; 0 if the device did not acknowledge the frames
+ */
+double StreamFrames(Connection& link, int window, std::vector<double>& latencies)
+{
+    std::vector<Clock::time_point> sentAt(FRAME_COUNT);
+    int sent = 0;
+    int acknowledged = 0;
+    Clock::time_point start = Clock::now();
+    while(acknowledged < FRAME_COUNT)
+    {
+        while(sent < FRAME_COUNT && sent - acknowledged < std::max(window, 1))
+        {
+            std::vector<uint8_t> stream;
+            stream.reserve(FRAME_HEADER_SIZE + LED_COUNT * 3);
+            AppendFrame(stream, PatternBody(LED_COUNT, sent), 0, Command::NONE, (uint8_t) sent);
+            sentAt[sent] = Clock::now();
+            link.Send(stream.data(), stream.size());
+            sent++;
+        }
+
+        uint8_t answer[2];
+        if(!ReadWithin(link, answer, window > 0 ? 2 : 1))
+        {
+            return 0;
+        }
+        int last = acknowledged;
+        if(window == 0 && answer[0] == FRAME_ACKNOWLEDGEMENT_BYTE)
+        {
+            last = acknowledged + 1;
+        }
+        else if(window > 0 && answer[0] == FRAME_CUMULATIVE_ACKNOWLEDGEMENT_BYTE)
+        {
+            last = acknowledged + (uint8_t) (answer[1] - (uint8_t) (acknowledged - 1));
+        }
+        if(last <= acknowledged || last > sent)
+        {
+            return 0;
+        }
+        for(; acknowledged < last; acknowledged++)
+        {
+            latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sentAt[acknowledged]).count());
+        }
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * function running a device and a master on the given connections
+ * @return: false if the frames were not streamed correctly
+ */
+bool Measure(const char* name, Connection& device, Connection& master, int window)
+{
+    std::vector<CRGB> leds(LED_COUNT);
+    Alup alup(leds.data(), LED_COUNT, 0, 0);
+    std::atomic<bool> running(true);
+    std::thread deviceThread([&] {
+        while(running)
+        {
+            if(!alup.connected)
+            {
+                alup.Connect(&device, "Bench", "");
+                continue;
+            }
+            alup.Run();
+            std::this_thread::yield();
+        }
+    });
+
+    master.Connect();
+    std::vector<double> latencies;
+    bool connected = MasterConnect(master, window);
+    double seconds = connected ? StreamFrames(master, window, latencies) : 0;
+    if(seconds == 0)
+    {
+        //the device may wait for the master forever
+        printf("%s: the device did not answer correctly\n", name);
+        exit(1);
+    }
+    running = false;
+    deviceThread.join();
+    master.Disconnect();
+    device.Disconnect();
+
+    std::vector<uint8_t> last = PatternBody(LED_COUNT, FRAME_COUNT - 1);
+    if(memcmp((void*) leds.data(), last.data(), last.size()) != 0)
+    {
+        printf("%s: the device did not show the last frame\n", name);
+        return false;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    printf("%-20s %8d %10.1f %12.0f %12.0f\n", name, window, FRAME_COUNT / seconds, latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]);
+    return true;
+}
+
+int main()
+{
+    //the device waits in real time between its connection requests
+    HostClock::SleepInDelay(true);
+
+    printf("%d leds, %d raw frames per run, real time\n", LED_COUNT, FRAME_COUNT);
+    printf("%-20s %8s %10s %12s %12s\n", "link", "window", "fps", "median us", "p99 us");
+    for(int window : {0, MASTER_WINDOW})
+    {
+        SocketConnection udpDevice(SOCKET_UDP, "127.0.0.1", MASTER_PORT, DEVICE_PORT);
+        SocketConnection udpMaster(SOCKET_UDP, "127.0.0.1", DEVICE_PORT, MASTER_PORT);
+        if(!Measure("UDP loopback", udpDevice, udpMaster, window))
+        {
+            return 1;
+        }
+        SocketConnection tcpDevice(SOCKET_TCP_SERVER, "", 0, DEVICE_PORT);
+        SocketConnection tcpMaster(SOCKET_TCP_CLIENT, "127.0.0.1", DEVICE_PORT, 0);
+        if(!Measure("TCP loopback", tcpDevice, tcpMaster, window))
+        {
+            return 1;
+        }
+        PtyConnection ptyDevice(PTY_BAUD);
+        PtyConnection ptyMaster(PTY_BAUD, ptyDevice.path.c_str());
+        if(ptyDevice.path.empty() || !Measure("PTY 1000000 baud", ptyDevice, ptyMaster, window))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
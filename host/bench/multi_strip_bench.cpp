@@ -0,0 +1,142 @@
+/**
+ * benchmark comparing the refresh rate of several led strips driven as one long logical strip
+ * with driving them as channels, over a simulated WiFi link with a pipeline window of 8.
+ * The time is simulated: the link latency, its transfer rate and the duration of FastLED.show()
+ * (30us per WS2812 led of the largest strip, as FastLED drives the strips in parallel) determine the result.
+ */
+
+#include "BenchCommon.h"
+#include "LoopbackConnection.h"
+
+#define STRIP_LEDS 300
+#define MAX_STRIPS 8
+#define WINDOW 32
+//the number of times all strips are updated per case
+#define ROUND_COUNT 50
+
+static CLEDController* controllers[MAX_STRIPS];
+static std::vector<CRGB> strips[MAX_STRIPS];
+
+/**
+ * function updating all strips ROUND_COUNT times
+ * @param stripCount: the number of strips
+ * @param useChannels: if true, each strip is a channel; else all strips are one logical strip
+ * @return: the number of times all strips are updated per second; 0 if the device did not answer correctly
+ */
+double MeasureRefreshRate(int stripCount, bool useChannels)
+{
+    LoopbackConnection device(2000, 2500000);
+    LoopbackConnection master(2000, 2500000);
+    LoopbackConnection::Pair(device, master);
+
+    //one logical strip uses the controller of the first strip for all leds
+    std::vector<CRGB> logical(stripCount * STRIP_LEDS);
+    for(int i = 0; i < MAX_STRIPS; i++)
+    {
+        strips[i].assign(STRIP_LEDS, CRGB(0, 0, 0));
+        controllers[i]->setLeds(strips[i].data(), useChannels && i < stripCount ? STRIP_LEDS : 0);
+    }
+    if(!useChannels)
+    {
+        controllers[0]->setLeds(logical.data(), logical.size());
+    }
+
+    Alup alup(useChannels ? strips[0].data() : logical.data(), useChannels ? STRIP_LEDS : logical.size(), 0, 0);
+    std::vector<uint8_t> answers = {CONNECTION_ACKNOWLEDGEMENT_BYTE};
+    AppendOption(answers, ConfigurationOption::PIPELINE_WINDOW, {WINDOW});
+    if(useChannels)
+    {
+        for(int i = 1; i < stripCount; i++)
+        {
+            alup.AddChannel(controllers[i]);
+        }
+        AppendOption(answers, ConfigurationOption::CHANNELS, std::vector<uint8_t>());
+    }
+    answers.push_back(CONFIGURATION_ACKNOWLEDGEMENT_BYTE);
+    master.Send(answers.data(), answers.size());
+    if(!alup.Connect(&device, "Bench", ""))
+    {
+        return 0;
+    }
+    while(master.InTransit())
+    {
+        uint8_t b;
+        master.Read(&b, 1);
+    }
+
+    //the frames of one round: one per channel or one for the logical strip
+    int framesPerRound = useChannels ? stripCount : 1;
+    int frameCount = ROUND_COUNT * framesPerRound;
+    int sent = 0;
+    int acknowledged = 0;
+    uint8_t lastAcknowledged = 255;
+    unsigned long start = micros();
+    while(acknowledged < frameCount)
+    {
+        while(sent < frameCount && sent - acknowledged < WINDOW)
+        {
+            int round = sent / framesPerRound + 1;
+            int channel = sent % framesPerRound;
+            std::vector<uint8_t> stream;
+            std::vector<uint8_t> body((useChannels ? STRIP_LEDS : logical.size()) * 3, (uint8_t) round);
+            AppendFrame(stream, body, (int32_t) ((uint32_t) channel << 24), Command::NONE, (uint8_t) sent);
+            master.Send(stream.data(), stream.size());
+            sent++;
+        }
+
+        alup.Run();
+
+        while(master.Available() > 0)
+        {
+            uint8_t answer;
+            uint8_t sequence;
+            master.Read(&answer, 1);
+            if(answer != FRAME_CUMULATIVE_ACKNOWLEDGEMENT_BYTE)
+            {
+                return 0;
+            }
+            master.Read(&sequence, 1);
+            acknowledged += (uint8_t) (sequence - lastAcknowledged);
+            lastAcknowledged = sequence;
+        }
+        HostClock::Advance(10);
+    }
+    double rate = ROUND_COUNT * 1e6 / (micros() - start);
+
+    //all strips have to show the last round
+    for(int i = 0; i < stripCount; i++)
+    {
+        CRGB* leds = useChannels ? strips[i].data() : &logical[i * STRIP_LEDS];
+        if(leds[0] != CRGB(ROUND_COUNT, ROUND_COUNT, ROUND_COUNT) || leds[STRIP_LEDS - 1] != leds[0])
+        {
+            return 0;
+        }
+    }
+    return rate;
+}
+
+int main()
+{
+    HostClock::Simulate(true);
+    FastLED.ledDuration = 30;
+    for(int i = 0; i < MAX_STRIPS; i++)
+    {
+        strips[i].resize(STRIP_LEDS);
+        controllers[i] = &FastLED.addLeds<WS2812B, 13, GRB>(strips[i].data(), STRIP_LEDS);
+    }
+
+    printf("strips of %d leds, WiFi UDP with 4ms RTT, window %d\n", STRIP_LEDS, WINDOW);
+    printf("%8s %16s %16s\n", "strips", "one strip fps", "channels fps");
+    for(int stripCount : {1, 2, 4, 8})
+    {
+        double single = MeasureRefreshRate(stripCount, false);
+        double channels = MeasureRefreshRate(stripCount, true);
+        if(single == 0 || channels == 0)
+        {
+            printf("unexpected answer from the device\n");
+            return 1;
+        }
+        printf("%8d %16.1f %16.1f\n", stripCount, single, channels);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * benchmark comparing driving several devices with one unicast frame each to one multicast frame
+ * addressing a universe shared by all devices, see ConfigurationOption::UNIVERSE.
+ * The multicast frame is delivered to every device; each one applies its own slice of it without
+ * sending acknowledgements. It reports what the master sends and answers per update and the time
+ * one device spends on an update, and checks that each device shows its slice.
+ */
+
+#include "BenchCommon.h"
+
+#define DEVICE_LEDS 300
+
+/**
+ * a device listening to the master
+ */
+struct Device
+{
+    std::vector<CRGB> leds;
+    MemoryConnection connection;
+    Alup alup;
+
+    Device() : leds(DEVICE_LEDS), alup(leds.data(), DEVICE_LEDS, 0, 0) {}
+};
+
+/**
+ * function updating all devices and measuring the time the first one spends on it
+ * @param multicast: if true, one universe frame is delivered to all devices; else each one gets its own frame
+ * @return: the time per update of one device in ns; 0 if a device did not show its slice
+ */
+double MeasureUpdate(int deviceCount, bool multicast, size_t& datagrams, size_t& bytes, size_t& answers)
+{
+    std::vector<Device> devices(deviceCount);
+    std::vector<uint8_t> universe = PatternBody(deviceCount * DEVICE_LEDS);
+    for(int i = 0; i < deviceCount; i++)
+    {
+        std::vector<uint8_t> options;
+        if(multicast)
+        {
+            std::vector<uint8_t> value(5);
+            Convert::Int32ToBytes(i * DEVICE_LEDS, value.data());
+            value[4] = 0;
+            AppendOption(options, ConfigurationOption::UNIVERSE, value);
+        }
+        if(!ConnectAlup(devices[i].alup, devices[i].connection, options))
+        {
+            return 0;
+        }
+    }
+
+    //the datagrams of one update; a multicast datagram is received by every device
+    std::vector<std::vector<uint8_t>> sent;
+    if(multicast)
+    {
+        sent.push_back(std::vector<uint8_t>());
+        AppendFrame(sent.back(), universe, 0, Command::NONE);
+    }
+    else
+    {
+        for(int i = 0; i < deviceCount; i++)
+        {
+            sent.push_back(std::vector<uint8_t>());
+            std::vector<uint8_t> slice(universe.begin() + i * DEVICE_LEDS * 3, universe.begin() + (i + 1) * DEVICE_LEDS * 3);
+            AppendFrame(sent.back(), slice, 0, Command::NONE);
+        }
+    }
+    datagrams = sent.size();
+    bytes = 0;
+    answers = 0;
+    for(int i = 0; i < deviceCount; i++)
+    {
+        const std::vector<uint8_t>& received = sent[multicast ? 0 : i];
+        bytes += i < (int) sent.size() ? sent[i].size() : 0;
+        devices[i].connection.Feed(received);
+        devices[i].alup.Run();
+        answers += devices[i].connection.sent.size();
+        if(memcmp((void*) devices[i].leds.data(), &universe[i * DEVICE_LEDS * 3], DEVICE_LEDS * 3) != 0)
+        {
+            return 0;
+        }
+    }
+
+    //the time of one device, which receives all colors when multicast is used
+    Device& device = devices[0];
+    return MeasureNanoseconds([&]()
+    {
+        device.connection.Rewind();
+        device.alup.Run();
+    });
+}
+
+int main()
+{
+    printf("devices of %d leds; per update of all devices\n", DEVICE_LEDS);
+    printf("%8s %-10s %10s %10s %10s %12s\n", "devices", "mode", "datagrams", "bytes", "answers", "device ns");
+    for(int deviceCount : {1, 4, 16, 32})
+    {
+        for(bool multicast : {false, true})
+        {
+            size_t datagrams;
+            size_t bytes;
+            size_t answers;
+            double ns = MeasureUpdate(deviceCount, multicast, datagrams, bytes, answers);
+            if(ns == 0)
+            {
+                printf("a device did not show its slice\n");
+                return 1;
+            }
+            printf("%8d %-10s %10zu %10zu %10zu %12.0f\n", deviceCount, multicast ? "multicast" : "unicast", datagrams, bytes, answers, ns);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * benchmark comparing the frame rate of stop-and-wait acknowledgements with pipelined frames
+ * over simulated links. The time is simulated: the link latency, its transfer rate and the
+ * duration of FastLED.show() (30us per WS2812 led) determine the result.
+ */
+
+#include "BenchCommon.h"
+#include "LoopbackConnection.h"
+
+//the number of frames sent per case
+#define FRAME_COUNT 300
+
+struct Link
+{
+    const char* name;
+    unsigned long latency;
+    unsigned long bytesPerSecond;
+};
+
+static const Link links[] = {
+    {"WiFi UDP, 4ms RTT", 2000, 2500000},
+    {"Serial 2Mbaud", 100, 200000},
+};
+static const int ledCounts[] = {30, 100, 1000};
+static const int windows[] = {0, 2, 4, 8, 16};
+
+/**
+ * function streaming frames to a device over the given link
+ * @param window: the pipeline window requested by the master; 0 for stop-and-wait (v0.2)
+ * @return: the frame rate in frames/s; 0 if the device did not answer correctly
+ */
+double MeasureFrameRate(const Link& link, int ledCount, int window)
+{
+    LoopbackConnection device(link.latency, link.bytesPerSecond);
+    LoopbackConnection master(link.latency, link.bytesPerSecond);
+    LoopbackConnection::Pair(device, master);
+
+    std::vector<CRGB> leds(ledCount);
+    Alup alup(leds.data(), ledCount, 0, 0);
+    FastLED.showDuration = ledCount * 30;
+
+    //answer the connection request and negotiate the window
+    std::vector<uint8_t> answers = {CONNECTION_ACKNOWLEDGEMENT_BYTE};
+    if(window > 0)
+    {
+        answers.insert(answers.end(), {CONFIGURATION_OPTION_BYTE, ConfigurationOption::PIPELINE_WINDOW, 1, (uint8_t) window});
+    }
+    answers.push_back(CONFIGURATION_ACKNOWLEDGEMENT_BYTE);
+    master.Send(answers.data(), answers.size());
+    if(!alup.Connect(&device, "Bench", ""))
+    {
+        return 0;
+    }
+
+    //skip everything the device sent during the handshake
+    while(master.InTransit())
+    {
+        uint8_t b;
+        master.Read(&b, 1);
+    }
+
+    std::vector<uint8_t> body = PatternBody(ledCount);
+    int sent = 0;
+    int acknowledged = 0;
+    uint8_t lastAcknowledged = 255;
+    unsigned long start = micros();
+    while(acknowledged < FRAME_COUNT)
+    {
+        //send as many frames as the window allows
+        while(sent < FRAME_COUNT && sent - acknowledged < (window > 0 ? window : 1))
+        {
+            std::vector<uint8_t> stream;
+            AppendFrame(stream, body, 0, Command::NONE, (uint8_t) sent);
+            master.Send(stream.data(), stream.size());
+            sent++;
+        }
+
+        alup.Run();
+
+        //evaluate the acknowledgements
+        while(master.Available() > 0)
+        {
+            uint8_t answer;
+            master.Read(&answer, 1);
+            if(answer == FRAME_ACKNOWLEDGEMENT_BYTE && window == 0)
+            {
+                acknowledged++;
+            }
+            else if(answer == FRAME_CUMULATIVE_ACKNOWLEDGEMENT_BYTE && window > 0)
+            {
+                uint8_t sequence;
+                master.Read(&sequence, 1);
+                acknowledged += (uint8_t) (sequence - lastAcknowledged);
+                lastAcknowledged = sequence;
+            }
+            else
+            {
+                return 0;
+            }
+        }
+        HostClock::Advance(10);
+    }
+    return FRAME_COUNT * 1e6 / (micros() - start);
+}
+
+int main()
+{
+    HostClock::Simulate(true);
+
+    for(const Link& link : links)
+    {
+        printf("%s\n", link.name);
+        printf("%8s", "leds");
+        for(int window : windows)
+        {
+            char title[16];
+            snprintf(title, sizeof(title), window == 0 ? "v0.2 fps" : "w=%d fps", window);
+            printf(" %10s", title);
+        }
+        printf("\n");
+
+        for(int ledCount : ledCounts)
+        {
+            printf("%8d", ledCount);
+            for(int window : windows)
+            {
+                double fps = MeasureFrameRate(link, ledCount, window);
+                if(fps == 0)
+                {
+                    printf("\nunexpected answer from the device\n");
+                    return 1;
+                }
+                printf(" %10.1f", fps);
+            }
+            printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+/**
+ * benchmark measuring how long the leds stay dark after the link to the master was lost
+ * A master connects with a capabilities query, a pipeline window, delta frames and a session token (see
+ * ConfigurationOption::SESSION), streams frames and then the simulated link drops. The device notices it in
+ * Run() and connects again like src/main.cpp. The time from the drop until the first delta frame after it was
+ * acknowledged is compared for a full handshake, a resumed session and a stale token, which falls back to
+ * the full handshake. The delta frame and its cumulative acknowledgement check that the options still apply.
+ */
+
+#include "BenchCommon.h"
+#include "InteractiveMaster.h"
+#include "MasterEncoder.h"
+
+#define LED_COUNT 100
+//the frames sent before the link drops
+#define FRAME_COUNT 10
+//the window negotiated by the master
+#define MASTER_WINDOW 8
+//the time a device loop takes
+#define LOOP_TIME 10
+
+struct Link
+{
+    const char* name;
+    unsigned long latency;
+    unsigned long bytesPerSecond;
+};
+
+static const Link links[] = {
+    {"WiFi UDP, 4ms RTT", 2000, 2500000},
+    {"Serial 115200 baud", 100, 11520},
+};
+
+enum Reconnect
+{
+    FULL_HANDSHAKE,
+    RESUME,
+    STALE_TOKEN
+};
+
+static const char* reconnectNames[] = {"full handshake", "resume", "stale token"};
+
+/**
+ * function negotiating the options of the benchmark like a master using them would
+ * @param token: the token of the new session
+ * @return: false if the device answered wrong
+ */
+bool Negotiate(InteractiveMaster& master, uint32_t& token)
+{
+    std::vector<uint8_t> answer;
+    if(!master.Option(ConfigurationOption::CAPABILITIES, std::vector<uint8_t>(), answer) || answer.size() < CAPABILITIES_SIZE)
+    {
+        return false;
+    }
+    if(!master.Option(ConfigurationOption::PIPELINE_WINDOW, std::vector<uint8_t>(1, MASTER_WINDOW), answer) || answer.size() != 1 || answer[0] != MASTER_WINDOW)
+    {
+        return false;
+    }
+    if(!master.Option(ConfigurationOption::COMMANDS, CommandsValue({Command::DELTA}), answer) || answer.size() != 4)
+    {
+        return false;
+    }
+    if(!master.Option(ConfigurationOption::SESSION, std::vector<uint8_t>(), answer) || answer.size() != 4)
+    {
+        return false;
+    }
+    token = Convert::BytesToInt32(answer.data());
+    return true;
+}
+
+/**
+ * function sending a delta frame changing the leds to the given colors and running the device until it was
+ * acknowledged cumulatively
+ * @return: false if the device answered anything else or did not apply the frame
+ */
+bool SendFrame(Alup& alup, LoopbackConnection& master, std::vector<CRGB>& leds, const std::vector<CRGB>& colors, uint8_t sequence)
+{
+    std::vector<uint8_t> stream;
+    AppendFrame(stream, MasterEncoder::Delta(leds, colors), 0, Command::DELTA, sequence);
+    master.Send(stream.data(), stream.size());
+    while(master.Available() < 2)
+    {
+        alup.Run();
+        HostClock::Advance(LOOP_TIME);
+    }
+    uint8_t answer[2];
+    master.Read(answer, 2);
+    return answer[0] == FRAME_CUMULATIVE_ACKNOWLEDGEMENT_BYTE && answer[1] == sequence && leds == colors;
+}
+
+/**
+ * function losing the link after some frames and measuring the time until frames are applied again
+ * @param resumed: if the session was resumed
+ * @return: the time in microseconds; 0 if the device did not answer correctly
+ */
+unsigned long MeasureReconnect(const Link& link, Reconnect reconnect, bool& resumed)
+{
+    LoopbackConnection device(link.latency, link.bytesPerSecond);
+    LoopbackConnection masterConnection(link.latency, link.bytesPerSecond);
+    LoopbackConnection::Pair(device, masterConnection);
+    std::vector<CRGB> leds(LED_COUNT);
+    Alup alup(leds.data(), LED_COUNT, 0, 0);
+
+    InteractiveMaster master(masterConnection);
+    uint32_t token = 0;
+    auto negotiate = [&](InteractiveMaster& negotiating) {
+        return Negotiate(negotiating, token);
+    };
+    if(!master.Connect(alup, device, negotiate))
+    {
+        return 0;
+    }
+    uint8_t sequence = 0;
+    for(int i = 0; i < FRAME_COUNT; i++)
+    {
+        std::vector<CRGB> colors(LED_COUNT, CRGB(i, 2 * i, 3 * i));
+        if(!SendFrame(alup, masterConnection, leds, colors, sequence++))
+        {
+            return 0;
+        }
+    }
+
+    device.Drop();
+    unsigned long start = HostClock::Micros();
+    alup.Run();
+    if(alup.connected)
+    {
+        return 0;
+    }
+    uint32_t resumeToken = reconnect == RESUME ? token : reconnect == STALE_TOKEN ? token + 1 : 0;
+    if(!master.Connect(alup, device, negotiate, resumeToken))
+    {
+        return 0;
+    }
+    resumed = master.resumed;
+    std::vector<CRGB> colors(LED_COUNT, CRGB(255, 128, 0));
+    if(!SendFrame(alup, masterConnection, leds, colors, sequence))
+    {
+        return 0;
+    }
+    return HostClock::Micros() - start;
+}
+
+int main()
+{
+    HostClock::Simulate(true);
+
+    printf("%d leds; time from a lost link until the first frame after it was acknowledged\n", LED_COUNT);
+    printf("%-20s %-16s %8s %12s\n", "link", "reconnect", "resumed", "dark ms");
+    for(const Link& link : links)
+    {
+        for(Reconnect reconnect : {FULL_HANDSHAKE, RESUME, STALE_TOKEN})
+        {
+            bool resumed = false;
+            unsigned long time = MeasureReconnect(link, reconnect, resumed);
+            if(time == 0 || resumed != (reconnect == RESUME))
+            {
+                printf("%s, %s: the device did not answer correctly\n", link.name, reconnectNames[reconnect]);
+                return 1;
+            }
+            printf("%-20s %-16s %8s %12.1f\n", link.name, reconnectNames[reconnect], resumed ? "yes" : "no", time / 1000.0);
+        }
+    }
+    return 0;
+}
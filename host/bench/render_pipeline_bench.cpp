@@ -0,0 +1,159 @@
+/**
+ * benchmark comparing the frame rate of showing frames in Run() with a RenderPipeline showing
+ * them on a second thread, in real time over a simulated 2 Mbaud link.
+ * Every frame is a solid color; each show() checks that the shown leds are not torn,
+ * i.e. that no frame is received into the buffer which is being shown.
+ * In both cases, frames received while the leds are shown are merged into the next show.
+ */
+
+#include "BenchCommon.h"
+#include "LoopbackConnection.h"
+#include "RenderPipeline.h"
+
+#define LED_COUNT 300
+#define FRAME_COUNT 40
+
+static CRGB front[LED_COUNT];
+static CRGB back[LED_COUNT];
+static CLEDController* controller;
+static int tornFrames = 0;
+//the color of the last shown frame, written by the thread showing the leds
+static std::atomic<int> lastShown(0);
+
+/**
+ * function checking that the shown leds belong to a single frame
+ */
+void CheckShownFrame()
+{
+    CRGB* shown = controller->leds();
+    lastShown = shown[0].r;
+    for(int i = 1; i < controller->size(); i++)
+    {
+        if(shown[i] != shown[0])
+        {
+            tornFrames++;
+            return;
+        }
+    }
+}
+
+/**
+ * function streaming solid color frames to a device
+ * @param pipeline: the pipeline presenting the frames; nullptr to show them in Run()
+ * @param window: the pipeline window requested by the master; 0 for stop-and-wait (v0.2)
+ * @return: the frame rate in frames/s; 0 if the frames were not shown correctly
+ */
+double MeasureFrameRate(RenderPipeline* pipeline, int window)
+{
+    LoopbackConnection device(100, 200000);
+    LoopbackConnection master(100, 200000);
+    LoopbackConnection::Pair(device, master);
+
+    memset((void*) front, 0, sizeof(front));
+    controller->setLeds(front, LED_COUNT);
+    Alup alup(front, LED_COUNT, 0, 0);
+    std::vector<uint8_t> answers = {CONNECTION_ACKNOWLEDGEMENT_BYTE};
+    if(window > 0)
+    {
+        answers.insert(answers.end(), {CONFIGURATION_OPTION_BYTE, ConfigurationOption::PIPELINE_WINDOW, 1, (uint8_t) window});
+    }
+    answers.push_back(CONFIGURATION_ACKNOWLEDGEMENT_BYTE);
+    master.Send(answers.data(), answers.size());
+    if(!alup.Connect(&device, "Bench", ""))
+    {
+        return 0;
+    }
+    while(master.InTransit())
+    {
+        uint8_t b;
+        master.Read(&b, 1);
+    }
+
+    if(pipeline != nullptr)
+    {
+        pipeline->Begin();
+        alup.UseRenderPipeline(pipeline);
+    }
+    tornFrames = 0;
+    lastShown = 0;
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    int sent = 0;
+    int acknowledged = 0;
+    uint8_t lastAcknowledged = 255;
+    while(acknowledged < FRAME_COUNT)
+    {
+        while(sent < FRAME_COUNT && sent - acknowledged < (window > 0 ? window : 1))
+        {
+            std::vector<uint8_t> stream;
+            AppendFrame(stream, std::vector<uint8_t>(LED_COUNT * 3, (uint8_t) (sent + 1)), 0, Command::NONE, (uint8_t) sent);
+            master.Send(stream.data(), stream.size());
+            sent++;
+        }
+
+        alup.Run();
+
+        while(master.Available() > 0)
+        {
+            uint8_t answer;
+            master.Read(&answer, 1);
+            if(answer == FRAME_ACKNOWLEDGEMENT_BYTE && window == 0)
+            {
+                acknowledged++;
+            }
+            else if(answer == FRAME_CUMULATIVE_ACKNOWLEDGEMENT_BYTE && window > 0)
+            {
+                uint8_t sequence;
+                master.Read(&sequence, 1);
+                acknowledged += (uint8_t) (sequence - lastAcknowledged);
+                lastAcknowledged = sequence;
+            }
+            else
+            {
+                return 0;
+            }
+        }
+    }
+
+    //the last frames are shown once the max refresh rate allows it
+    while(lastShown != FRAME_COUNT)
+    {
+        alup.Run();
+        std::this_thread::yield();
+    }
+    if(pipeline != nullptr)
+    {
+        pipeline->End();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if(tornFrames > 0 || controller->leds()[0] != CRGB(FRAME_COUNT, FRAME_COUNT, FRAME_COUNT))
+    {
+        printf("frames were not shown correctly: %d torn\n", tornFrames);
+        return 0;
+    }
+    return FRAME_COUNT / seconds;
+}
+
+int main()
+{
+    controller = &FastLED.addLeds<WS2812B, 13, GRB>(front, LED_COUNT);
+    FastLED.showDuration = LED_COUNT * 30;
+    FastLED.onShow = CheckShownFrame;
+    RenderPipeline pipeline(controller, front, back, LED_COUNT);
+
+    printf("%d leds, show() %d us, 2 Mbaud link\n", LED_COUNT, FastLED.showDuration);
+    printf("%14s %14s %14s\n", "master", "Run() fps", "pipeline fps");
+    for(int window : {0, 4})
+    {
+        double direct = MeasureFrameRate(nullptr, window);
+        double pipelined = MeasureFrameRate(&pipeline, window);
+        if(direct == 0 || pipelined == 0)
+        {
+            return 1;
+        }
+        printf("%14s %14.1f %14.1f\n", window == 0 ? "stop-and-wait" : "window 4", direct, pipelined);
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+/**
+ * benchmark measuring how long a device takes to apply frames again after a single bit of the stream was flipped,
+ * with plain v0.2 frames and with frames framed by a sync word and CRCs (see ConfigurationOption::FRAMING).
+ * The master keeps streaming frames over a simulated 115200 baud serial link without waiting for acknowledgements;
+ * the recovery time is measured from the end of the corrupted frame to the first correct frame shown after it.
+ */
+
+#include "BenchCommon.h"
+#include "LoopbackConnection.h"
+
+#define LED_COUNT 100
+#define FRAME_COUNT 60
+//the frame in which a bit is flipped
+#define CORRUPTED_FRAME 10
+//the bytes/s of a 115200 baud serial link with 8N1
+#define LINK_BYTES_PER_SECOND 11520
+//the time a device loop takes
+#define LOOP_TIME 100
+//the time simulated after the last frame was sent
+#define SETTLE_TIME 1000000
+
+/**
+ * a bit flipped in the corrupted frame
+ */
+struct Corruption
+{
+    const char* name;
+    //the index of the byte in the frame, not counting the sync word
+    int byte;
+    uint8_t mask;
+};
+
+static const Corruption corruptions[] = {
+    {"length bit 0", 3, 0x01},
+    {"length bit 14", 2, 0x40},
+    {"length bit 30", 0, 0x40},
+    {"command bit 2", 8, 0x04},
+    {"body byte 50", FRAME_HEADER_SIZE + 50, 0x01},
+};
+
+static std::vector<CRGB>* shownLeds;
+//the time at which each frame was shown correctly
+static unsigned long shownAt[FRAME_COUNT];
+
+/**
+ * function building the body of the given frame; each frame has different colors
+ */
+std::vector<uint8_t> FrameBody(int frame)
+{
+    return PatternBody(LED_COUNT, frame * 11 + 1);
+}
+
+/**
+ * function recording the time a frame is shown if the leds match one of the frames
+ */
+void RecordShow()
+{
+    for(int frame = 0; frame < FRAME_COUNT; frame++)
+    {
+        std::vector<uint8_t> body = FrameBody(frame);
+        if(shownAt[frame] == 0 && memcmp(shownLeds->data(), body.data(), body.size()) == 0)
+        {
+            shownAt[frame] = HostClock::Micros();
+        }
+    }
+}
+
+/**
+ * function streaming frames with a flipped bit to a device and measuring its recovery
+ * @param framed: if the frames are framed by a sync word and CRCs
+ * @param corruption: the bit flipped in the corrupted frame
+ * @param lost: the number of frames after the corrupted one which were never shown
+ * @return: the recovery time in microseconds; -1 if no frame was shown after the corrupted one
+ */
+long MeasureRecovery(bool framed, const Corruption& corruption, int& lost)
+{
+    std::vector<CRGB> leds(LED_COUNT);
+    LoopbackConnection connection(0, LINK_BYTES_PER_SECOND);
+    LoopbackConnection master(0, LINK_BYTES_PER_SECOND);
+    LoopbackConnection::Pair(connection, master);
+    Alup alup(leds.data(), LED_COUNT, 0, 0);
+
+    //connect; the answers of the master are sent before they are asked for
+    std::vector<uint8_t> answers;
+    answers.push_back(CONNECTION_ACKNOWLEDGEMENT_BYTE);
+    if(framed)
+    {
+        AppendOption(answers, ConfigurationOption::FRAMING, std::vector<uint8_t>(1, 1));
+    }
+    answers.push_back(CONFIGURATION_ACKNOWLEDGEMENT_BYTE);
+    master.Send(answers.data(), answers.size());
+    if(!alup.Connect(&connection, "Bench", ""))
+    {
+        return -1;
+    }
+
+    //the time at which each frame is sent; the link is never idle for long
+    std::vector<std::vector<uint8_t>> frames(FRAME_COUNT);
+    for(int frame = 0; frame < FRAME_COUNT; frame++)
+    {
+        if(framed)
+        {
+            AppendFramedFrame(frames[frame], FrameBody(frame), 0, Command::NONE);
+        }
+        else
+        {
+            AppendFrame(frames[frame], FrameBody(frame), 0, Command::NONE);
+        }
+    }
+    frames[CORRUPTED_FRAME][corruption.byte + (framed ? FRAME_SYNC_SIZE : 0)] ^= corruption.mask;
+    unsigned long frameTime = frames[0].size() * 1000000UL / LINK_BYTES_PER_SECOND;
+    unsigned long start = HostClock::Micros();
+
+    memset(shownAt, 0, sizeof(shownAt));
+    shownLeds = &leds;
+    FastLED.onShow = RecordShow;
+    int sent = 0;
+    while((long) (HostClock::Micros() - (start + FRAME_COUNT * frameTime + SETTLE_TIME)) < 0)
+    {
+        if(sent < FRAME_COUNT && (long) (HostClock::Micros() - (start + sent * frameTime)) >= 0)
+        {
+            master.Send(frames[sent].data(), frames[sent].size());
+            sent++;
+        }
+        alup.Run();
+        //discard the answers
+        uint8_t answer[64];
+        while(master.Available() > 0)
+        {
+            master.Read(answer, sizeof(answer));
+        }
+        HostClock::Advance(LOOP_TIME);
+    }
+    FastLED.onShow = nullptr;
+
+    lost = 0;
+    long recovery = -1;
+    unsigned long corruptedEnd = start + (CORRUPTED_FRAME + 1) * frameTime;
+    for(int frame = CORRUPTED_FRAME + 1; frame < FRAME_COUNT; frame++)
+    {
+        if(shownAt[frame] == 0)
+        {
+            lost++;
+        }
+        else if(recovery < 0)
+        {
+            recovery = shownAt[frame] - corruptedEnd;
+        }
+    }
+    return recovery;
+}
+
+/**
+ * function checking that the colors of a corrupted body are not shown by a following frame changing a part of the leds
+ * @return: 1 if the corrupted colors were never shown and a frame replacing them was, else 0
+ */
+int CheckCorruptedBody()
+{
+    const int ledCount = 10;
+    const uint8_t corrupted = 0x77;
+    std::vector<CRGB> leds(ledCount, CRGB(0, 0, 0));
+    MemoryConnection connection;
+    Alup alup(leds.data(), ledCount, 0, 0);
+    std::vector<uint8_t> options;
+    AppendOption(options, ConfigurationOption::FRAMING, std::vector<uint8_t>(1, 1));
+    if(!ConnectAlup(alup, connection, options))
+    {
+        printf("could not connect\n");
+        return 0;
+    }
+
+    int corruptedShows = 0;
+    FastLED.onShow = [&]()
+    {
+        for(const CRGB& led : leds)
+        {
+            corruptedShows += led.r == corrupted;
+        }
+    };
+    unsigned long showCount = FastLED.showCount;
+
+    //a black frame of which the red color of led 5 was corrupted, followed by a frame changing only led 0
+    std::vector<uint8_t> stream;
+    AppendFramedFrame(stream, std::vector<uint8_t>(ledCount * 3, 0), 0, Command::NONE);
+    stream[FRAME_SYNC_SIZE + FRAME_HEADER_SIZE + FRAME_CRC_SIZE + 5 * 3] ^= corrupted;
+    AppendFramedFrame(stream, std::vector<uint8_t>({1, 2, 3}), 0, Command::NONE);
+    connection.Feed(stream);
+    for(int i = 0; i < 10; i++)
+    {
+        alup.Run();
+        HostClock::Advance(LOOP_TIME);
+    }
+    bool held = corruptedShows == 0 && FastLED.showCount == showCount;
+
+    //resending the corrupted frame replaces the damaged colors
+    stream.clear();
+    AppendFramedFrame(stream, std::vector<uint8_t>(ledCount * 3, 0), 0, Command::NONE);
+    connection.Feed(stream);
+    for(int i = 0; i < 10; i++)
+    {
+        alup.Run();
+        HostClock::Advance(LOOP_TIME);
+    }
+    FastLED.onShow = nullptr;
+
+    if(!held || corruptedShows != 0 || FastLED.showCount == showCount)
+    {
+        printf("the colors of a corrupted body were shown %d times\n", corruptedShows);
+        return 0;
+    }
+    return 1;
+}
+
+int main()
+{
+    HostClock::Simulate(true);
+
+    printf("%d leds, frames streamed over a 115200 baud serial link; a bit of frame %d of %d is flipped\n", LED_COUNT, CORRUPTED_FRAME, FRAME_COUNT);
+    printf("%-10s %-16s %14s %12s\n", "frames", "flipped bit", "recovery ms", "frames lost");
+    for(bool framed : {false, true})
+    {
+        for(const Corruption& corruption : corruptions)
+        {
+            int lost;
+            long recovery = MeasureRecovery(framed, corruption, lost);
+            if(recovery < 0)
+            {
+                printf("%-10s %-16s %14s %12d\n", framed ? "framed" : "v0.2", corruption.name, "never", lost);
+                continue;
+            }
+            printf("%-10s %-16s %14.1f %12d\n", framed ? "framed" : "v0.2", corruption.name, recovery / 1000.0, lost);
+        }
+    }
+    return CheckCorruptedBody() ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+/**
+ * benchmark comparing ways of updating a few scattered indicators on a static strip over simulated links
+ * with stop-and-wait acknowledgements: resending the whole strip, one frame per indicator and one SCATTER frame.
+ * The time is simulated: the link latency, its transfer rate and the duration of FastLED.show()
+ * (30us per WS2812 led) determine the result.
+ */
+
+#include "BenchCommon.h"
+#include "LoopbackConnection.h"
+#include "MasterEncoder.h"
+
+#define LED_COUNT 1000
+//the indicators changed with each update
+#define INDICATOR_COUNT 5
+#define INDICATOR_SIZE 4
+//the number of updates sent per case
+#define UPDATE_COUNT 100
+
+struct Link
+{
+    const char* name;
+    unsigned long latency;
+    unsigned long bytesPerSecond;
+};
+
+static const Link links[] = {
+    {"WiFi UDP, 4ms RTT", 2000, 2500000},
+    {"Serial 2Mbaud", 100, 200000},
+};
+
+enum Method
+{
+    FULL_STRIP,
+    FRAME_PER_INDICATOR,
+    SCATTER_FRAME
+};
+
+/**
+ * function building the colors of the strip after the given update
+ */
+std::vector<CRGB> BuildStrip(int update)
+{
+    std::vector<CRGB> colors(LED_COUNT, CRGB(0, 0, 40));
+    for(int i = 0; i < INDICATOR_COUNT; i++)
+    {
+        for(int j = 0; j < INDICATOR_SIZE; j++)
+        {
+            colors[i * (LED_COUNT / INDICATOR_COUNT) + j] = CRGB(update, 255 - update, i * 50);
+        }
+    }
+    return colors;
+}
+
+/**
+ * function building the frames sending the given update
+ * @return: the frames, each one being acknowledged before the next one is sent
+ */
+std::vector<std::vector<uint8_t>> BuildFrames(Method method, int update)
+{
+    std::vector<CRGB> colors = BuildStrip(update);
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<ScatterSegment> segments;
+    for(int i = 0; i < INDICATOR_COUNT; i++)
+    {
+        int32_t offset = i * (LED_COUNT / INDICATOR_COUNT);
+        segments.push_back({offset, std::vector<CRGB>(colors.begin() + offset, colors.begin() + offset + INDICATOR_SIZE)});
+    }
+
+    switch(method)
+    {
+        case FULL_STRIP:
+            frames.push_back(std::vector<uint8_t>());
+            AppendFrame(frames.back(), MasterEncoder::Raw(colors), 0, Command::NONE);
+            break;
+
+        case FRAME_PER_INDICATOR:
+            for(const ScatterSegment& segment : segments)
+            {
+                frames.push_back(std::vector<uint8_t>());
+                AppendFrame(frames.back(), MasterEncoder::Raw(segment.colors), segment.offset, Command::NONE);
+            }
+            break;
+
+        case SCATTER_FRAME:
+            frames.push_back(std::vector<uint8_t>());
+            AppendFrame(frames.back(), MasterEncoder::Scatter(segments), 0, Command::SCATTER);
+            break;
+    }
+    return frames;
+}
+
+/**
+ * function sending the updates to a device over the given link
+ * @param bytes: set to the bytes sent per update
+ * @return: the updates/s; 0 if the device did not answer correctly
+ */
+double MeasureUpdateRate(const Link& link, Method method, size_t& bytes)
+{
+    LoopbackConnection device(link.latency, link.bytesPerSecond);
+    LoopbackConnection master(link.latency, link.bytesPerSecond);
+    LoopbackConnection::Pair(device, master);
+
+    std::vector<CRGB> leds = BuildStrip(0);
+    Alup alup(leds.data(), LED_COUNT, 0, 0);
+    FastLED.showDuration = LED_COUNT * 30;
+
+    std::vector<uint8_t> answers = {CONNECTION_ACKNOWLEDGEMENT_BYTE};
+    AppendOption(answers, ConfigurationOption::COMMANDS, CommandsValue({Command::SCATTER}));
+    answers.push_back(CONFIGURATION_ACKNOWLEDGEMENT_BYTE);
+    master.Send(answers.data(), answers.size());
+    if(!alup.Connect(&device, "Bench", ""))
+    {
+        return 0;
+    }
+    while(master.InTransit())
+    {
+        uint8_t b;
+        master.Read(&b, 1);
+    }
+
+    unsigned long showCount = FastLED.showCount;
+    unsigned long start = micros();
+    for(int update = 1; update <= UPDATE_COUNT; update++)
+    {
+        bytes = 0;
+        for(std::vector<uint8_t>& frame : BuildFrames(method, update))
+        {
+            bytes += frame.size();
+            master.Send(frame.data(), frame.size());
+            while(master.Available() == 0)
+            {
+                alup.Run();
+                HostClock::Advance(10);
+            }
+            uint8_t answer;
+            master.Read(&answer, 1);
+            if(answer != FRAME_ACKNOWLEDGEMENT_BYTE)
+            {
+                return 0;
+            }
+        }
+    }
+    double rate = UPDATE_COUNT * 1e6 / (micros() - start);
+
+    if(leds != BuildStrip(UPDATE_COUNT))
+    {
+        return 0;
+    }
+    printf(" %6lu", (FastLED.showCount - showCount) / UPDATE_COUNT);
+    return rate;
+}
+
+int main()
+{
+    HostClock::Simulate(true);
+    const char* names[] = {"full strip", "frame per indicator", "scatter frame"};
+
+    printf("%d leds, %d indicators of %d leds\n", LED_COUNT, INDICATOR_COUNT, INDICATOR_SIZE);
+    for(const Link& link : links)
+    {
+        printf("%s\n", link.name);
+        printf("%-20s %6s %8s %12s\n", "method", "shows", "bytes", "updates/s");
+        for(Method method : {FULL_STRIP, FRAME_PER_INDICATOR, SCATTER_FRAME})
+        {
+            printf("%-20s", names[method]);
+            size_t bytes = 0;
+            double rate = MeasureUpdateRate(link, method, bytes);
+            if(rate == 0)
+            {
+                printf("\nunexpected answer from the device\n");
+                return 1;
+            }
+            printf(" %8zu %12.1f\n", bytes, rate);
+        }
+    }
+    return 0;
+}
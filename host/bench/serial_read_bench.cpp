@@ -0,0 +1,86 @@
+/**
+ * benchmark comparing the byte throughput of SerialConnection::Read() with the
+ * per-byte read it replaced, for different receive buffer and request sizes
+ */
+
+#include "BenchCommon.h"
+#include "SerialConnection.h"
+
+/**
+ * the read path of SerialConnection before reads were chunked: one readBytes() call per byte
+ * Note: SerialConnection is final, so everything but Read() is forwarded to it
+ */
+class PerByteSerialConnection : public Connection
+{
+    public:
+        SerialConnection serial = SerialConnection(115200);
+
+        void Connect() { serial.Connect(); }
+        void Disconnect() { serial.Disconnect(); }
+        void Send(uint8_t* bytes, size_t length) { serial.Send(bytes, length); }
+        int Available() { return serial.Available(); }
+        bool isConnected() { return serial.isConnected(); }
+
+        int Read(uint8_t* buffer, size_t length)
+        {
+            uint8_t temp[1];
+            for(size_t i = 0; i < length; i ++)
+            {
+                while(Available() < 1)
+                {
+                    //wait for data
+                }
+                Serial.readBytes(temp, 1);
+                buffer[i] = temp[0];
+            }
+            return length;
+        }
+};
+
+//the number of bytes read per measured iteration
+#define STREAM_SIZE 65536
+
+static const size_t rxBufferSizes[] = {64, 256, 1024};
+static const size_t requestSizes[] = {4, 64, 900, 3000};
+
+/**
+ * function measuring the throughput of the given connection
+ * @return: the throughput in bytes/s
+ */
+double MeasureBytesPerSecond(Connection& connection, size_t requestSize)
+{
+    std::vector<uint8_t> buffer(requestSize);
+    double ns = MeasureNanoseconds([&]()
+    {
+        Serial.Rewind();
+        for(size_t count = 0; count + requestSize <= STREAM_SIZE; count += requestSize)
+        {
+            connection.Read(buffer.data(), requestSize);
+        }
+    });
+    return (STREAM_SIZE / requestSize) * requestSize * 1e9 / ns;
+}
+
+int main()
+{
+    std::vector<uint8_t> stream = PatternBody(STREAM_SIZE / 3 + 1);
+    PerByteSerialConnection perByte;
+    SerialConnection chunked(115200);
+
+    printf("%10s %10s %16s %16s %8s\n", "rx buffer", "request", "per byte B/s", "chunked B/s", "speedup");
+    for(size_t rxBufferSize : rxBufferSizes)
+    {
+        for(size_t requestSize : requestSizes)
+        {
+            chunked.Connect();
+            Serial.Clear();
+            Serial.Feed(stream.data(), STREAM_SIZE);
+            Serial.setRxBufferSize(rxBufferSize);
+
+            double before = MeasureBytesPerSecond(perByte, requestSize);
+            double after = MeasureBytesPerSecond(chunked, requestSize);
+            printf("%10zu %10zu %16.0f %16.0f %7.1fx\n", rxBufferSize, requestSize, before, after, after / before);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * benchmark streaming frames faster than a WS2812 strip can show them, like a master updating a few
+ * segments of a strip in separate frames or sending full frames at a high rate over WiFi.
+ * The device merges the frames applied between two shows and shows at most at its max refresh rate, see
+ * Alup::SetMaxRefreshRate(). It reports the frames and shows per second and checks that the leds end with
+ * all frames applied and that the leds were not shown more often than allowed.
+ * The time is simulated: the link and the duration of FastLED.show() (30us per led) determine the result.
+ */
+
+#include "BenchCommon.h"
+#include "LoopbackConnection.h"
+
+//the number of frames sent per case
+#define FRAME_COUNT 600
+//the pipeline window requested by the master
+#define MASTER_WINDOW 16
+//the time it takes to show one WS2812 led
+#define WS2812_LED_DURATION 30
+//a WiFi link with 4ms round trip time
+#define LINK_LATENCY 2000
+#define LINK_BYTES_PER_SECOND 2500000
+
+struct Case
+{
+    const char* name;
+    int ledCount;
+    //the number of leds changed by each frame; each frame changes the next segment of the strip
+    int segmentSize;
+    //the max refresh rate of the device; 0 to derive it from the led type
+    uint32_t maxRefreshRate;
+};
+
+static const Case cases[] = {
+    {"full frames", 1000, 1000, 0},
+    {"full frames", 100, 100, 0},
+    {"full frames", 100, 100, 60},
+    {"10 segments", 1000, 100, 0},
+    {"10 segments", 100, 10, 0},
+};
+
+/**
+ * function streaming the frames of the given case to a device
+ * @param shows: the number of times the leds were shown
+ * @return: the time in seconds; 0 if the device did not answer correctly or showed wrong leds
+ */
+double Stream(const Case& test, unsigned long& shows)
+{
+    LoopbackConnection device(LINK_LATENCY, LINK_BYTES_PER_SECOND);
+    LoopbackConnection master(LINK_LATENCY, LINK_BYTES_PER_SECOND);
+    LoopbackConnection::Pair(device, master);
+
+    std::vector<CRGB> leds(test.ledCount);
+    Alup alup(leds.data(), test.ledCount, 0, 0);
+    alup.SetMaxRefreshRate(test.maxRefreshRate);
+    FastLED.showDuration = test.ledCount * WS2812_LED_DURATION;
+
+    std::vector<uint8_t> answers = {CONNECTION_ACKNOWLEDGEMENT_BYTE};
+    answers.insert(answers.end(), {CONFIGURATION_OPTION_BYTE, ConfigurationOption::PIPELINE_WINDOW, 1, MASTER_WINDOW});
+    answers.push_back(CONFIGURATION_ACKNOWLEDGEMENT_BYTE);
+    master.Send(answers.data(), answers.size());
+    if(!alup.Connect(&device, "Bench", ""))
+    {
+        return 0;
+    }
+    while(master.InTransit())
+    {
+        uint8_t b;
+        master.Read(&b, 1);
+    }
+
+    //the colors the leds have once all frames are applied
+    std::vector<uint8_t> expected(test.ledCount * 3);
+    int segments = test.ledCount / test.segmentSize;
+    int sent = 0;
+    int acknowledged = 0;
+    uint8_t lastAcknowledged = 255;
+    unsigned long showsBefore = FastLED.showCount;
+    unsigned long start = micros();
+    while(acknowledged < FRAME_COUNT)
+    {
+        while(sent < FRAME_COUNT && sent - acknowledged < MASTER_WINDOW)
+        {
+            int offset = (sent % segments) * test.segmentSize;
+            std::vector<uint8_t> body = PatternBody(test.segmentSize, sent);
+            memcpy(&expected[offset * 3], body.data(), body.size());
+            std::vector<uint8_t> stream;
+            stream.reserve(FRAME_HEADER_SIZE + body.size());
+            AppendFrame(stream, body, offset, Command::NONE, (uint8_t) sent);
+            master.Send(stream.data(), stream.size());
+            sent++;
+        }
+
+        alup.Run();
+
+        while(master.Available() > 0)
+        {
+            uint8_t answer[2];
+            master.Read(answer, 2);
+            if(answer[0] != FRAME_CUMULATIVE_ACKNOWLEDGEMENT_BYTE)
+            {
+                return 0;
+            }
+            acknowledged += (uint8_t) (answer[1] - lastAcknowledged);
+            lastAcknowledged = answer[1];
+        }
+        HostClock::Advance(10);
+    }
+    unsigned long end = micros();
+
+    //the last frames are shown once the max refresh rate allows it
+    HostClock::Advance(alup.statistics.showTime.total);
+    alup.Run();
+    shows = FastLED.showCount - showsBefore;
+    if(memcmp((void*) leds.data(), expected.data(), expected.size()) != 0)
+    {
+        return 0;
+    }
+    return (end - start) / 1e6;
+}
+
+int main()
+{
+    HostClock::Simulate(true);
+
+    printf("WiFi UDP with 4ms RTT, window %d, %d frames, WS2812 leds (%d us per led)\n", MASTER_WINDOW, FRAME_COUNT, WS2812_LED_DURATION);
+    printf("%-12s %6s %10s %12s %10s %10s %12s\n", "frames", "leds", "max rate", "1 show fps", "fps", "shows/s", "frames/show");
+    for(const Case& test : cases)
+    {
+        unsigned long shows = 0;
+        double seconds = Stream(test, shows);
+        if(seconds == 0)
+        {
+            printf("%s, %d leds: the device did not apply all frames\n", test.name, test.ledCount);
+            return 1;
+        }
+        //the rate the leds could be shown if every frame was shown
+        double showBound = 1e6 / (test.ledCount * WS2812_LED_DURATION);
+        uint32_t maxRate = test.maxRefreshRate > 0 ? test.maxRefreshRate : ALUP_CLOCKLESS_MAX_REFRESH_RATE;
+        //the first show starts the stream
+        double showRate = (shows - 1) / seconds;
+        char rate[16] = "auto";
+        if(test.maxRefreshRate > 0)
+        {
+            snprintf(rate, sizeof(rate), "%u Hz", test.maxRefreshRate);
+        }
+        printf("%-12s %6d %10s %12.1f %10.1f %10.1f %12.1f\n", test.name, test.ledCount, rate, showBound, FRAME_COUNT / seconds, showRate, (double) FRAME_COUNT / shows);
+        //allow the show of the last frames after the stream ended
+        if(showRate > maxRate + 1 / seconds)
+        {
+            printf("the leds were shown more often than %u times per second\n", maxRate);
+            return 1;
+        }
+    }
+    return 0;
+}
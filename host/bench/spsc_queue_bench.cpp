@@ -0,0 +1,199 @@
+/**
+ * benchmark handing packets from a receive thread to a consumer thread, like AsyncUdpConnection hands them
+ * from the async udp task to loop(). The producer fills packets from a pool and queues pointers to them;
+ * the consumer checks and returns them to the pool through a second queue, so no payload is copied.
+ * SpscQueue is compared with a queue guarded by a mutex. It reports the packets/s when the producer
+ * sends as fast as it can and the time from queueing a packet until the consumer got it when the
+ * packets are paced like a stream of frames.
+ */
+
+#include "SpscQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+//the payload of a datagram on an ethernet/WiFi MTU of 1500 bytes
+#define PACKET_SIZE 1472
+//the packets which can wait for the consumer, see ALUP_ASYNC_UDP_QUEUE_SIZE
+#define QUEUE_SIZE 16
+//the packets of the pool; the producer waits if all of them are queued or being read
+//Note: the queue returning them has to be able to hold all of them
+#define POOL_SIZE QUEUE_SIZE
+#define THROUGHPUT_PACKETS 500000
+#define LATENCY_PACKETS 5000
+//the time between two paced packets in microseconds
+#define LATENCY_INTERVAL 100
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * a received packet
+ */
+struct Packet
+{
+    uint32_t sequence;
+    Clock::time_point queued;
+    uint8_t payload[PACKET_SIZE];
+};
+
+/**
+ * queue guarded by a mutex, offering the interface of SpscQueue
+ */
+template<class T>
+class MutexQueue
+{
+    public:
+        bool Push(const T& item)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(items.size() == QUEUE_SIZE)
+            {
+                return false;
+            }
+            items.push_back(item);
+            return true;
+        }
+
+        bool Pop(T& item)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(items.empty())
+            {
+                return false;
+            }
+            item = items.front();
+            items.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex mutex;
+        std::deque<T> items;
+};
+
+/**
+ * function waiting until the given item could be pushed
+ */
+template<class Q, class T>
+void PushWaiting(Q& queue, const T& item)
+{
+    while(!queue.Push(item))
+    {
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * function waiting until an item could be popped
+ */
+template<class Q, class T>
+void PopWaiting(Q& queue, T& item)
+{
+    while(!queue.Pop(item))
+    {
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * function sending the given number of packets from a producer to a consumer thread
+ * @param interval: the time between two packets in microseconds; 0 to send as fast as possible
+ * @param latencies: the time each packet waited in the queue in microseconds
+ * @return: the time in seconds; 0 if a packet was lost, reordered or corrupted
+ */
+template<template<class> class Queue>
+double Transfer(int count, int interval, std::vector<double>& latencies)
+{
+    static Packet pool[POOL_SIZE];
+    static Queue<Packet*> received;
+    static Queue<Packet*> free;
+    for(int i = 0; i < POOL_SIZE; i++)
+    {
+        PushWaiting(free, &pool[i]);
+    }
+    latencies.clear();
+    bool ok = true;
+
+    Clock::time_point start = Clock::now();
+    std::thread consumer([&] {
+        for(int i = 0; i < count; i++)
+        {
+            Packet* packet;
+            PopWaiting(received, packet);
+            latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - packet->queued).count());
+            if(packet->sequence != (uint32_t) i || packet->payload[0] != (uint8_t) i || packet->payload[PACKET_SIZE - 1] != (uint8_t) i)
+            {
+                ok = false;
+            }
+            PushWaiting(free, packet);
+        }
+    });
+    for(int i = 0; i < count; i++)
+    {
+        Packet* packet;
+        PopWaiting(free, packet);
+        packet->sequence = i;
+        packet->payload[0] = i;
+        packet->payload[PACKET_SIZE - 1] = i;
+        if(interval > 0)
+        {
+            Clock::time_point due = start + std::chrono::microseconds((long) i * interval);
+            while(Clock::now() < due)
+            {
+                std::this_thread::yield();
+            }
+        }
+        packet->queued = Clock::now();
+        PushWaiting(received, packet);
+    }
+    consumer.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    //return the pool
+    Packet* packet;
+    while(free.Pop(packet));
+    return ok ? seconds : 0;
+}
+
+template<class T>
+using Spsc = SpscQueue<T, QUEUE_SIZE>;
+
+/**
+ * function measuring the given queue
+ * @return: false if a packet was lost, reordered or corrupted
+ */
+template<template<class> class Queue>
+bool Measure(const char* name)
+{
+    std::vector<double> latencies;
+    double seconds = Transfer<Queue>(THROUGHPUT_PACKETS, 0, latencies);
+    if(seconds == 0)
+    {
+        return false;
+    }
+    double rate = THROUGHPUT_PACKETS / seconds;
+    if(Transfer<Queue>(LATENCY_PACKETS, LATENCY_INTERVAL, latencies) == 0)
+    {
+        return false;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    printf("%-12s %14.0f %14.1f %14.1f\n", name, rate, latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]);
+    return true;
+}
+
+int main()
+{
+    printf("%d byte packets queued as pointers, queue of %d, %u hardware threads\n", PACKET_SIZE, QUEUE_SIZE, std::thread::hardware_concurrency());
+    printf("%-12s %14s %14s %14s\n", "queue", "packets/s", "median us", "p99 us");
+    if(!Measure<Spsc>("SpscQueue") || !Measure<MutexQueue>("mutex"))
+    {
+        printf("packets were lost, reordered or corrupted\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * benchmark comparing Alup, which calls its connection through the virtual Connection interface,
+ * with a StaticAlup using the final MemoryConnection and supporting only the run length command.
+ * For each workload, it reports the time of Alup::Run() per frame and the resulting frame rate; the RAM
+ * used by each device object is reported as well, which is smaller for StaticAlup because it stores one channel.
+ * Note: the flash used on a board has to be measured with its tool chain, e.g. the size reported after building
+ */
+
+#include "BenchCommon.h"
+#include "MasterEncoder.h"
+
+#define LED_COUNT 300
+//the number of frames replayed per iteration of the small frame workload
+#define SMALL_FRAME_COUNT 100
+
+//the commands supported by the static device
+#define STATIC_COMMANDS (1UL << Command::RUN_LENGTH)
+
+typedef StaticAlup<MemoryConnection, LED_COUNT, STATIC_COMMANDS> StaticDevice;
+
+/**
+ * a stream of frames replayed by a workload
+ */
+struct Workload
+{
+    const char* name;
+    std::vector<uint8_t> stream;
+    //the number of frames in the stream
+    int frames;
+};
+
+/**
+ * function building the workloads measured
+ */
+std::vector<Workload> BuildWorkloads()
+{
+    std::vector<Workload> workloads;
+
+    std::vector<CRGB> colors(LED_COUNT);
+    for(int i = 0; i < LED_COUNT; i++)
+    {
+        colors[i] = CRGB(i, 255 - i / 2, i * 3);
+    }
+    Workload full = {"full frame", std::vector<uint8_t>(), 1};
+    AppendFrame(full.stream, MasterEncoder::Raw(colors), 0, Command::NONE);
+    workloads.push_back(full);
+
+    //one led per frame, so the header and the connection calls dominate
+    Workload small = {"1 led frames", std::vector<uint8_t>(), SMALL_FRAME_COUNT};
+    for(int i = 0; i < SMALL_FRAME_COUNT; i++)
+    {
+        AppendFrame(small.stream, MasterEncoder::Raw(std::vector<CRGB>(1, colors[i])), i, Command::NONE);
+    }
+    workloads.push_back(small);
+
+    //a different color every 4 leds, so the body is read in chunks and decoded
+    std::vector<CRGB> runs(LED_COUNT);
+    for(int i = 0; i < LED_COUNT; i++)
+    {
+        runs[i] = colors[i / 4 * 4];
+    }
+    Workload runLength = {"run length", std::vector<uint8_t>(), 1};
+    AppendFrame(runLength.stream, MasterEncoder::RunLength(runs), 0, Command::RUN_LENGTH);
+    workloads.push_back(runLength);
+
+    return workloads;
+}
+
+/**
+ * function measuring Run() while replaying the given workload
+ * @param alup: a device connected to connection
+ * @return: the time per frame in ns; 0 if not all frames were acknowledged
+ */
+template<class AlupT>
+double MeasureWorkload(AlupT& alup, MemoryConnection& connection, const Workload& workload)
+{
+    connection.Clear();
+    connection.Feed(workload.stream);
+    double ns = MeasureNanoseconds([&]()
+    {
+        connection.Rewind();
+        connection.sent.clear();
+        alup.Run();
+    });
+    if(connection.sent != std::vector<uint8_t>(workload.frames, FRAME_ACKNOWLEDGEMENT_BYTE))
+    {
+        return 0;
+    }
+    return ns / workload.frames;
+}
+
+int main()
+{
+    static CRGB dynamicLeds[LED_COUNT];
+    static CRGB staticLeds[LED_COUNT];
+    MemoryConnection dynamicConnection;
+    MemoryConnection staticConnection;
+    Alup dynamicAlup(dynamicLeds, LED_COUNT, 0, 0);
+    StaticDevice staticAlup(staticLeds, 0, 0);
+
+    std::vector<uint8_t> options;
+    AppendOption(options, ConfigurationOption::COMMANDS, CommandsValue({Command::RUN_LENGTH}));
+    if(!ConnectAlup(dynamicAlup, dynamicConnection, options) || !ConnectAlup(staticAlup, staticConnection, options))
+    {
+        printf("could not connect\n");
+        return 1;
+    }
+
+    printf("%d leds\n", LED_COUNT);
+    printf("RAM of the device object: Alup %zu bytes, StaticAlup %zu bytes\n", sizeof(Alup), sizeof(StaticDevice));
+    if(sizeof(StaticDevice) + (ALUP_MAX_CHANNELS - 1) * sizeof(LedChannel) > sizeof(Alup))
+    {
+        printf("StaticAlup stores more than one channel\n");
+        return 1;
+    }
+    printf("%-14s %-12s %12s %12s\n", "workload", "device", "ns/frame", "frames/s");
+    for(const Workload& workload : BuildWorkloads())
+    {
+        double dynamicNs = MeasureWorkload(dynamicAlup, dynamicConnection, workload);
+        double staticNs = MeasureWorkload(staticAlup, staticConnection, workload);
+        if(dynamicNs == 0 || staticNs == 0 || memcmp(dynamicLeds, staticLeds, sizeof(dynamicLeds)) != 0)
+        {
+            printf("%s was not applied correctly\n", workload.name);
+            return 1;
+        }
+        printf("%-14s %-12s %12.0f %12.0f\n", workload.name, "Alup", dynamicNs, 1e9 / dynamicNs);
+        printf("%-14s %-12s %12.0f %12.0f\n", workload.name, "StaticAlup", staticNs, 1e9 / staticNs);
+    }
+    return 0;
+}
@@ -0,0 +1,229 @@
+/**
+ * benchmark polling the STATISTICS command like a monitor of many devices would
+ * A master sends full frames with stop-and-wait acknowledgements over simulated serial links and polls the
+ * statistics before and after; the last frames are run length encoded. From the difference of both answers it calculates the effective frame rate and
+ * the share of the time spent in each stage, which tells if the link or FastLED.show() limits the frame rate.
+ * The counters and the number of frames in the read and decode histograms are checked against the frames actually sent.
+ * The frames are sent in packets like those of a USB serial adapter, so the read time includes waiting for the link.
+ * Note: decoding takes no simulated time on the host, so its share is always 0 here
+ */
+
+#include "BenchCommon.h"
+#include "LoopbackConnection.h"
+#include "MasterEncoder.h"
+
+//the number of frames sent between the two polls
+#define FRAME_COUNT 100
+//the number of them which are run length encoded
+#define ENCODED_FRAME_COUNT 10
+//the size of the packets the master sends
+#define PACKET_SIZE 64
+//the time a device loop takes
+#define LOOP_TIME 50
+//the time it takes to show one WS2812 led
+#define WS2812_LED_DURATION 30
+
+/**
+ * the answer to the STATISTICS command as sent by Statistics::Write()
+ */
+struct StatisticsAnswer
+{
+    uint32_t time;
+    uint32_t framesApplied;
+    uint32_t frameErrors;
+    uint32_t bytesReceived;
+    uint32_t bytesSent;
+    uint32_t resyncs;
+    uint32_t connections;
+    uint32_t shows;
+    //the counts and total time of the read, decode and show histograms
+    uint32_t histograms[3][HISTOGRAM_BUCKETS];
+    uint64_t totals[3];
+
+    /**
+     * function returning the number of durations in the given histogram: 0 read, 1 decode, 2 show
+     */
+    uint32_t Count(int histogram)
+    {
+        uint32_t count = 0;
+        for(int i = 0; i < HISTOGRAM_BUCKETS; i++)
+        {
+            count += histograms[histogram][i];
+        }
+        return count;
+    }
+};
+
+/**
+ * function parsing the given answer to the STATISTICS command
+ * @param bytes: the bytes following STATISTICS_BYTE; has to have a size of STATISTICS_SIZE
+ */
+StatisticsAnswer ParseStatistics(uint8_t* bytes)
+{
+    StatisticsAnswer answer;
+    uint32_t counters[8];
+    for(int i = 0; i < 8; i++)
+    {
+        counters[i] = Convert::BytesToInt32(&bytes[4 * i]);
+    }
+    memcpy(&answer, counters, sizeof(counters));
+    for(int i = 0; i < 3; i++)
+    {
+        uint8_t* histogram = &bytes[sizeof(counters) + i * HISTOGRAM_SIZE];
+        for(int j = 0; j < HISTOGRAM_BUCKETS; j++)
+        {
+            answer.histograms[i][j] = Convert::BytesToInt32(&histogram[4 * j]);
+        }
+        answer.totals[i] = ((uint64_t) (uint32_t) Convert::BytesToInt32(&histogram[4 * HISTOGRAM_BUCKETS]) << 32) | (uint32_t) Convert::BytesToInt32(&histogram[4 * HISTOGRAM_BUCKETS + 4]);
+    }
+    return answer;
+}
+
+/**
+ * a device and the master end of its link
+ */
+struct Link
+{
+    LoopbackConnection connection;
+    LoopbackConnection master;
+    Alup& alup;
+
+    Link(Alup& _alup, unsigned long bytesPerSecond) : connection(0, bytesPerSecond), master(0, bytesPerSecond), alup {_alup}
+    {
+        LoopbackConnection::Pair(connection, master);
+    }
+
+    /**
+     * function running the device until the master received the given number of bytes
+     */
+    void Receive(uint8_t* buffer, int length)
+    {
+        while(master.Available() < length)
+        {
+            alup.Run();
+            HostClock::Advance(LOOP_TIME);
+        }
+        master.Read(buffer, length);
+    }
+
+    /**
+     * function sending the given bytes to the device in packets of PACKET_SIZE
+     */
+    void Send(std::vector<uint8_t>& stream)
+    {
+        for(size_t i = 0; i < stream.size(); i += PACKET_SIZE)
+        {
+            master.Send(&stream[i], stream.size() - i < PACKET_SIZE ? stream.size() - i : PACKET_SIZE);
+        }
+    }
+
+    /**
+     * function sending a STATISTICS frame and reading the answer and the acknowledgement
+     * @return: false if the answer is invalid
+     */
+    bool Poll(StatisticsAnswer& answer)
+    {
+        std::vector<uint8_t> stream;
+        AppendFrame(stream, std::vector<uint8_t>(), 0, Command::STATISTICS);
+        Send(stream);
+        uint8_t bytes[1 + STATISTICS_SIZE + 1];
+        Receive(bytes, sizeof(bytes));
+        answer = ParseStatistics(&bytes[1]);
+        return bytes[0] == STATISTICS_BYTE && bytes[sizeof(bytes) - 1] == FRAME_ACKNOWLEDGEMENT_BYTE;
+    }
+};
+
+/**
+ * function sending frames to a device and reporting its statistics
+ * @param name: the name of the case shown in the output
+ * @return: 1 if the statistics match the frames sent, else 0
+ */
+int MeasureCase(const char* name, int ledCount, unsigned long bytesPerSecond)
+{
+    std::vector<CRGB> leds(ledCount);
+    Alup alup(leds.data(), ledCount, 0, 0);
+    Link link(alup, bytesPerSecond);
+    FastLED.showDuration = ledCount * WS2812_LED_DURATION;
+
+    std::vector<uint8_t> answers;
+    answers.push_back(CONNECTION_ACKNOWLEDGEMENT_BYTE);
+    AppendOption(answers, ConfigurationOption::COMMANDS, CommandsValue({Command::STATISTICS, Command::RUN_LENGTH}));
+    answers.push_back(CONFIGURATION_ACKNOWLEDGEMENT_BYTE);
+    link.master.Send(answers.data(), answers.size());
+    if(!alup.Connect(&link.connection, "Bench", ""))
+    {
+        return 0;
+    }
+    //discard the connection requests and the configuration
+    while(link.master.InTransit())
+    {
+        uint8_t discarded[64];
+        link.master.Read(discarded, sizeof(discarded));
+    }
+
+    StatisticsAnswer before;
+    StatisticsAnswer after;
+    if(!link.Poll(before))
+    {
+        return 0;
+    }
+    std::vector<uint8_t> stream;
+    AppendFrame(stream, PatternBody(ledCount), 0, Command::NONE);
+    //a different color every 4 leds
+    std::vector<CRGB> runs(ledCount);
+    for(int i = 0; i < ledCount; i++)
+    {
+        runs[i] = CRGB(i / 4, 255 - i / 4, 0);
+    }
+    std::vector<uint8_t> encoded;
+    AppendFrame(encoded, MasterEncoder::RunLength(runs), 0, Command::RUN_LENGTH);
+    for(int i = 0; i < FRAME_COUNT; i++)
+    {
+        link.Send(i < FRAME_COUNT - ENCODED_FRAME_COUNT ? stream : encoded);
+        uint8_t acknowledgement;
+        link.Receive(&acknowledgement, 1);
+    }
+    if(!link.Poll(after))
+    {
+        return 0;
+    }
+
+    //the first poll is counted by the second one
+    int rawFrames = FRAME_COUNT - ENCODED_FRAME_COUNT;
+    if(after.framesApplied - before.framesApplied != FRAME_COUNT + 1 || after.shows - before.shows != FRAME_COUNT
+        || after.bytesReceived - before.bytesReceived != rawFrames * stream.size() + ENCODED_FRAME_COUNT * encoded.size() + FRAME_HEADER_SIZE
+        || after.frameErrors != 0 || after.connections != 1)
+    {
+        printf("%s: the statistics do not match the frames sent\n", name);
+        return 0;
+    }
+    if(after.Count(0) - before.Count(0) != FRAME_COUNT + 1 || after.Count(1) - before.Count(1) != ENCODED_FRAME_COUNT
+        || after.Count(2) - before.Count(2) != FRAME_COUNT || after.totals[0] == before.totals[0])
+    {
+        printf("%s: the histograms do not match the frames read, decoded and shown\n", name);
+        return 0;
+    }
+
+    double elapsed = after.time - before.time;
+    double fps = (after.shows - before.shows) * 1e6 / elapsed;
+    double stages[3];
+    for(int i = 0; i < 3; i++)
+    {
+        stages[i] = (after.totals[i] - before.totals[i]) * 100.0 / elapsed;
+    }
+    double received = (after.bytesReceived - before.bytesReceived) * 1e6 / elapsed;
+    printf("%-26s %8.1f %12.0f %8.1f %8.1f %8.1f\n", name, fps, received, stages[0], stages[1], stages[2]);
+    return 1;
+}
+
+int main()
+{
+    HostClock::Simulate(true);
+
+    printf("stop-and-wait frames; the share of the time is calculated from the statistics of the device\n");
+    printf("%-26s %8s %12s %8s %8s %8s\n", "case", "fps", "bytes/s in", "read %", "decode %", "show %");
+    int ok = MeasureCase("300 leds, 115200 baud", 300, 11520);
+    ok = ok && MeasureCase("1000 leds, 2 Mbaud", 1000, 200000);
+    FastLED.showDuration = 0;
+    return ok ? 0 : 1;
+}
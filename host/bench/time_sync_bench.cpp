@@ -0,0 +1,284 @@
+/**
+ * benchmark measuring how far apart several devices show the same frame over a jittery WiFi link,
+ * comparing showing frames on arrival with presentation times after a TIME_SYNC exchange.
+ * All devices run in one program with simulated time; each one has its own clock offset (see HostClock::SetOffset())
+ * and its own link to the master with a random latency per datagram.
+ */
+
+#include "BenchCommon.h"
+#include "LoopbackConnection.h"
+
+#define DEVICE_COUNT 10
+#define LED_COUNT 100
+#define FRAME_COUNT 50
+//the link: 2ms latency plus up to 8ms jitter, 2.5MB/s
+#define LINK_LATENCY 2000
+#define LINK_JITTER 8000
+#define LINK_BYTES_PER_SECOND 2500000
+//the number of TIME_SYNC frames sent to each device, see MeasureClockOffset()
+#define SYNC_ROUNDS 16
+//the time between sending a frame and its presentation time
+#define PRESENTATION_DELAY 30000
+//the time a device loop takes
+#define LOOP_TIME 50
+
+struct Device
+{
+    std::vector<CRGB> leds;
+    LoopbackConnection connection;
+    LoopbackConnection master;
+    Alup alup;
+    long clockOffset;
+
+    Device() : leds(LED_COUNT), connection(LINK_LATENCY, LINK_BYTES_PER_SECOND, LINK_JITTER),
+        master(LINK_LATENCY, LINK_BYTES_PER_SECOND, LINK_JITTER), alup(leds.data(), LED_COUNT, 0, 0)
+    {
+        LoopbackConnection::Pair(connection, master);
+        clockOffset = rand() % 1000000 - 500000;
+    }
+};
+
+static std::vector<Device>* devices;
+//the device which is currently running and the time at which it showed each frame
+static int running = -1;
+static unsigned long shownAt[DEVICE_COUNT][FRAME_COUNT + 1];
+
+/**
+ * function recording the time the running device shows a frame; the frame number is the color of its leds
+ */
+void RecordShow()
+{
+    Device& device = (*devices)[running];
+    shownAt[running][device.leds[0].r] = HostClock::Micros();
+}
+
+/**
+ * function running the loop of every device once
+ */
+void Step()
+{
+    for(int i = 0; i < DEVICE_COUNT; i++)
+    {
+        running = i;
+        HostClock::SetOffset((*devices)[i].clockOffset);
+        (*devices)[i].alup.Run();
+        HostClock::SetOffset(0);
+    }
+    HostClock::Advance(LOOP_TIME);
+}
+
+/**
+ * function reading the given amount of bytes sent by a device while all devices keep running
+ */
+void ReadAnswer(Device& device, uint8_t* buffer, int length)
+{
+    while(device.master.Available() < length)
+    {
+        Step();
+    }
+    device.master.Read(buffer, length);
+}
+
+/**
+ * function sending a TIME_SYNC frame and reading its answer
+ * @param offset: the offset which is sent to the device; nullptr to only measure
+ * @param forward: the time from sending the frame to the answer in device time, i.e. latency + clock offset
+ * @param backward: the time from the answer in device time to receiving it, i.e. latency - clock offset
+ * @param skew: the skew reported by the device
+ */
+void SyncClock(Device& device, const long* offset, long& forward, long& backward, long& skew)
+{
+    std::vector<uint8_t> body(offset != nullptr ? 8 : 4);
+    unsigned long sent = micros();
+    Convert::Int32ToBytes(sent, body.data());
+    if(offset != nullptr)
+    {
+        Convert::Int32ToBytes(*offset, &body[4]);
+    }
+    std::vector<uint8_t> stream;
+    AppendFrame(stream, body, 0, Command::TIME_SYNC);
+    device.master.Send(stream.data(), stream.size());
+
+    //the answer followed by the acknowledgement
+    uint8_t answer[14];
+    ReadAnswer(device, answer, sizeof(answer));
+    unsigned long received = micros();
+    unsigned long deviceTime = Convert::BytesToInt32(&answer[5]);
+    forward = (long) (deviceTime - sent);
+    backward = (long) (received - deviceTime);
+    skew = Convert::BytesToInt32(&answer[9]);
+}
+
+/**
+ * function measuring the offset of the clock of the given device
+ * Like NTP, the offset is half the difference of the forward and backward delays. Using the minimum of
+ * each direction over several exchanges removes most of the jitter.
+ * @return: the device clock minus the master clock in microseconds
+ */
+long MeasureClockOffset(Device& device)
+{
+    long minForward = 0;
+    long minBackward = 0;
+    for(int i = 0; i < SYNC_ROUNDS; i++)
+    {
+        long forward;
+        long backward;
+        long skew;
+        SyncClock(device, nullptr, forward, backward, skew);
+        minForward = i == 0 || forward < minForward ? forward : minForward;
+        minBackward = i == 0 || backward < minBackward ? backward : minBackward;
+    }
+    return (minForward - minBackward) / 2;
+}
+
+/**
+ * function sending FRAME_COUNT frames to all devices at the same time
+ * @param timestamped: if true, the frames have a presentation time; else they are shown on arrival
+ * @param maxSpread: the longest time between the first and the last device showing a frame
+ * @param syncError: the largest difference of a measured clock offset to the actual one
+ * @param maxSkew: the largest skew reported by a device
+ * @return: the average time between the first and the last device showing a frame in microseconds; -1 if a frame was not shown
+ * or a timestamped frame was acknowledged before it was shown
+ */
+double MeasureSpread(bool timestamped, long& maxSpread, long& syncError, long& maxSkew)
+{
+    syncError = 0;
+    std::vector<Device> list(DEVICE_COUNT);
+    devices = &list;
+    std::vector<uint8_t> options;
+    AppendOption(options, ConfigurationOption::COMMANDS, CommandsValue({Command::TIME_SYNC}));
+    for(int i = 0; i < DEVICE_COUNT; i++)
+    {
+        std::vector<uint8_t> answers;
+        answers.reserve(options.size() + 2);
+        answers.push_back(CONNECTION_ACKNOWLEDGEMENT_BYTE);
+        answers.insert(answers.end(), options.begin(), options.end());
+        answers.push_back(CONFIGURATION_ACKNOWLEDGEMENT_BYTE);
+        list[i].master.Send(answers.data(), answers.size());
+        running = i;
+        HostClock::SetOffset(list[i].clockOffset);
+        int connected = list[i].alup.Connect(&list[i].connection, "Bench", "");
+        HostClock::SetOffset(0);
+        if(!connected)
+        {
+            return -1;
+        }
+        while(list[i].master.InTransit())
+        {
+            uint8_t b;
+            list[i].master.Read(&b, 1);
+        }
+    }
+
+    //measure the offset of each device and send it to the device
+    if(timestamped)
+    {
+        for(Device& device : list)
+        {
+            long offset = MeasureClockOffset(device);
+            long forward;
+            long backward;
+            long skew;
+            SyncClock(device, &offset, forward, backward, skew);
+            long error = labs(offset - device.clockOffset);
+            syncError = error > syncError ? error : syncError;
+        }
+    }
+
+    memset(shownAt, 0, sizeof(shownAt));
+    FastLED.onShow = RecordShow;
+    for(int frame = 1; frame <= FRAME_COUNT; frame++)
+    {
+        //the same frame is sent to every device
+        unsigned long presentationTime = micros() + PRESENTATION_DELAY;
+        for(Device& device : list)
+        {
+            std::vector<uint8_t> stream;
+            AppendFrame(stream, std::vector<uint8_t>(LED_COUNT * 3, frame), 0, Command::NONE);
+            if(timestamped)
+            {
+                stream[8] |= FRAME_PRESENTATION_FLAG;
+                uint8_t time[PRESENTATION_TIME_SIZE];
+                Convert::Int32ToBytes(presentationTime, time);
+                stream.insert(stream.begin() + FRAME_HEADER_SIZE, time, time + PRESENTATION_TIME_SIZE);
+            }
+            device.master.Send(stream.data(), stream.size());
+        }
+        for(int i = 0; i < DEVICE_COUNT; i++)
+        {
+            uint8_t answer;
+            ReadAnswer(list[i], &answer, 1);
+            //a master waiting for the acknowledgement sends the next frame once the device can read it
+            if(answer != FRAME_ACKNOWLEDGEMENT_BYTE || (timestamped && shownAt[i][frame] == 0))
+            {
+                return -1;
+            }
+        }
+        //wait until every device showed the frame
+        for(int i = 0; i < DEVICE_COUNT; i++)
+        {
+            while(shownAt[i][frame] == 0 && (long) (micros() - presentationTime) < PRESENTATION_DELAY)
+            {
+                Step();
+            }
+        }
+    }
+    FastLED.onShow = nullptr;
+
+    //the skew measured by each device
+    maxSkew = 0;
+    if(timestamped)
+    {
+        for(Device& device : list)
+        {
+            long forward;
+            long backward;
+            long skew;
+            SyncClock(device, nullptr, forward, backward, skew);
+            maxSkew = skew > maxSkew ? skew : maxSkew;
+        }
+    }
+
+    double spread = 0;
+    maxSpread = 0;
+    for(int frame = 1; frame <= FRAME_COUNT; frame++)
+    {
+        unsigned long first = shownAt[0][frame];
+        unsigned long last = shownAt[0][frame];
+        for(int i = 0; i < DEVICE_COUNT; i++)
+        {
+            if(shownAt[i][frame] == 0)
+            {
+                return -1;
+            }
+            first = (long) (shownAt[i][frame] - first) < 0 ? shownAt[i][frame] : first;
+            last = (long) (shownAt[i][frame] - last) > 0 ? shownAt[i][frame] : last;
+        }
+        spread += last - first;
+        maxSpread = (long) (last - first) > maxSpread ? last - first : maxSpread;
+    }
+    return spread / FRAME_COUNT;
+}
+
+int main()
+{
+    HostClock::Simulate(true);
+    srand(1);
+
+    printf("%d devices, WiFi link with %dms latency and up to %dms jitter, clocks up to 500ms apart\n", DEVICE_COUNT, LINK_LATENCY / 1000, LINK_JITTER / 1000);
+    printf("%-20s %12s %12s %14s %16s\n", "mode", "spread us", "max us", "sync error us", "device skew us");
+    for(bool timestamped : {false, true})
+    {
+        long maxSpread;
+        long syncError;
+        long maxSkew;
+        double spread = MeasureSpread(timestamped, maxSpread, syncError, maxSkew);
+        if(spread < 0)
+        {
+            printf("frames were not shown by every device or acknowledged before they were shown\n");
+            return 1;
+        }
+        printf("%-20s %12.0f %12ld %14ld %16ld\n", timestamped ? "presentation time" : "shown on arrival", spread, maxSpread, syncError, maxSkew);
+    }
+    return 0;
+}
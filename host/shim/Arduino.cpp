@@ -0,0 +1,268 @@
+#include "Arduino.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+
+HardwareSerial Serial;
+
+//the pins written using digitalWrite()
+static uint8_t pinStates[256];
+//the time passed in delay() which was simulated instead of slept
+static std::atomic<unsigned long long> simulatedMicros(0);
+//the start of the program
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+//if true, only the simulated time is used
+static std::atomic<bool> simulatedOnly(false);
+//if true, delay() sleeps while the time is not simulated
+static std::atomic<bool> sleepInDelay(false);
+//the offset of the clock of the simulated device
+static std::atomic<long> clockOffset(0);
+
+/**
+ * function returning the real time passed since the start of the program
+ */
+static unsigned long long RealMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void HostClock::Simulate(bool simulated)
+{
+    //continue from the current time so that time never runs backwards
+    if(simulated && !simulatedOnly)
+    {
+        simulatedMicros += RealMicros();
+    }
+    else if(!simulated && simulatedOnly)
+    {
+        simulatedMicros -= RealMicros();
+    }
+    simulatedOnly = simulated;
+}
+
+bool HostClock::IsSimulated()
+{
+    return simulatedOnly;
+}
+
+void HostClock::Advance(unsigned long us)
+{
+    simulatedMicros += us;
+}
+
+void HostClock::SetOffset(long us)
+{
+    clockOffset = us;
+}
+
+unsigned long HostClock::Micros()
+{
+    if(simulatedOnly)
+    {
+        return (unsigned long) simulatedMicros;
+    }
+    return (unsigned long) (RealMicros() + simulatedMicros);
+}
+
+unsigned long micros()
+{
+    return HostClock::Micros() + clockOffset;
+}
+
+unsigned long millis()
+{
+    return micros() / 1000;
+}
+
+void HostClock::SleepInDelay(bool sleep)
+{
+    sleepInDelay = sleep;
+}
+
+/**
+ * function sleeping or simulating the given time
+ */
+static void Delay(unsigned long long us)
+{
+    if(sleepInDelay && !simulatedOnly)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+        return;
+    }
+    simulatedMicros += us;
+}
+
+void delay(unsigned long ms)
+{
+    Delay((unsigned long long) ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    Delay(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void) pin;
+    (void) mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    pinStates[pin] = value;
+}
+
+int digitalRead(uint8_t pin)
+{
+    return pinStates[pin];
+}
+
+
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        write(buffer[i]);
+    }
+    return size;
+}
+
+size_t Print::print(const char* text)
+{
+    return write((const uint8_t*) text, strlen(text));
+}
+
+size_t Print::print(const String& text)
+{
+    return print(text.c_str());
+}
+
+size_t Print::print(char c)
+{
+    return write((uint8_t) c);
+}
+
+size_t Print::print(unsigned char number)
+{
+    return print((unsigned long) number);
+}
+
+size_t Print::print(int number)
+{
+    return print((long) number);
+}
+
+size_t Print::print(unsigned int number)
+{
+    return print((unsigned long) number);
+}
+
+size_t Print::print(long number)
+{
+    char text[24];
+    snprintf(text, sizeof(text), "%ld", number);
+    return print(text);
+}
+
+size_t Print::print(unsigned long number)
+{
+    char text[24];
+    snprintf(text, sizeof(text), "%lu", number);
+    return print(text);
+}
+
+size_t Print::println()
+{
+    return print("\r\n");
+}
+
+
+
+void HardwareSerial::begin(unsigned long _baud)
+{
+    baud = _baud;
+    begun = true;
+}
+
+void HardwareSerial::end()
+{
+    begun = false;
+}
+
+void HardwareSerial::setTimeout(unsigned long _timeout)
+{
+    timeout = _timeout;
+}
+
+size_t HardwareSerial::setRxBufferSize(size_t size)
+{
+    rxBufferSize = size;
+    return size;
+}
+
+int HardwareSerial::available()
+{
+    size_t count = received.size() - readPosition;
+    return count > rxBufferSize ? rxBufferSize : count;
+}
+
+int HardwareSerial::read()
+{
+    if(readPosition >= received.size())
+    {
+        return -1;
+    }
+    return received[readPosition++];
+}
+
+int HardwareSerial::peek()
+{
+    if(readPosition >= received.size())
+    {
+        return -1;
+    }
+    return received[readPosition];
+}
+
+size_t HardwareSerial::readBytes(uint8_t* buffer, size_t length)
+{
+    //the timeout bookkeeping of the board cores is done once per call
+    unsigned long start = millis();
+    (void) start;
+
+    size_t count = received.size() - readPosition;
+    if(count > length)
+    {
+        count = length;
+    }
+    memcpy(buffer, received.data() + readPosition, count);
+    readPosition += count;
+    return count;
+}
+
+size_t HardwareSerial::write(uint8_t b)
+{
+    sent.push_back(b);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+    sent.insert(sent.end(), buffer, buffer + size);
+    return size;
+}
+
+void HardwareSerial::Feed(const uint8_t* bytes, size_t length)
+{
+    received.insert(received.end(), bytes, bytes + length);
+}
+
+void HardwareSerial::Clear()
+{
+    received.clear();
+    readPosition = 0;
+    sent.clear();
+}
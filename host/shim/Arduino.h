@@ -0,0 +1,194 @@
+#ifndef ALUP_HOST_ARDUINO_H
+#define ALUP_HOST_ARDUINO_H
+
+/**
+ * minimal stand-in for the Arduino core which is used to build the ALUP library on a Linux host
+ * Note: only the parts of the Arduino API used by this library are provided
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define LED_BUILTIN 2
+
+/**
+ * function returning the microseconds passed since the start of the program
+ * Note: time spent in delay() is simulated and added to the result without actually sleeping,
+ * unless HostClock::SleepInDelay() was enabled
+ */
+unsigned long micros();
+/**
+ * function returning the milliseconds passed since the start of the program
+ */
+unsigned long millis();
+/**
+ * function advancing the simulated time by the given amount of milliseconds
+ */
+void delay(unsigned long ms);
+/**
+ * function advancing the simulated time by the given amount of microseconds
+ */
+void delayMicroseconds(unsigned int us);
+
+/**
+ * control over the time returned by micros() and millis() on the host
+ */
+class HostClock
+{
+    public:
+        /**
+         * function switching between real and simulated time
+         * @param simulated: if true, time only advances using Advance(), delay() and delayMicroseconds()
+         */
+        static void Simulate(bool simulated);
+        static bool IsSimulated();
+        /**
+         * function advancing the time by the given amount of microseconds without sleeping
+         */
+        static void Advance(unsigned long us);
+        /**
+         * function setting an offset added to micros() and millis(), e.g. to simulate the clock
+         * of one of several devices which are run by the same program
+         */
+        static void SetOffset(long us);
+        /**
+         * function returning the time in microseconds without the offset
+         */
+        static unsigned long Micros();
+        /**
+         * function letting delay() and delayMicroseconds() sleep in real time instead of simulating it,
+         * e.g. while exchanging bytes with another process
+         * Note: only has an effect while the time is not simulated
+         * @param sleep: true to sleep
+         */
+        static void SleepInDelay(bool sleep);
+};
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+/**
+ * stand-in for the Arduino String class
+ */
+class String
+{
+    public:
+        String(const char* text = "") : value {text} {}
+        String(const std::string& text) : value {text} {}
+
+        unsigned int length() const { return value.length(); }
+        const char* c_str() const { return value.c_str(); }
+
+        /**
+         * function copying the characters into the given buffer including a null terminator
+         * Note: the text is truncated if the buffer is too small, like on the Arduino core
+         */
+        void getBytes(unsigned char* buffer, unsigned int bufferSize, unsigned int index = 0) const
+        {
+            if(bufferSize == 0 || buffer == nullptr)
+            {
+                return;
+            }
+            if(index >= value.length())
+            {
+                buffer[0] = 0;
+                return;
+            }
+            unsigned int n = value.length() - index;
+            if(n > bufferSize - 1)
+            {
+                n = bufferSize - 1;
+            }
+            memcpy(buffer, value.data() + index, n);
+            buffer[n] = 0;
+        }
+
+    private:
+        std::string value;
+};
+
+/**
+ * stand-in for the Arduino Print class
+ * Note: everything printed ends up in write()
+ */
+class Print
+{
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t b) = 0;
+        virtual size_t write(const uint8_t* buffer, size_t size);
+
+        size_t print(const char* text);
+        size_t print(const String& text);
+        size_t print(char c);
+        size_t print(unsigned char number);
+        size_t print(int number);
+        size_t print(unsigned int number);
+        size_t print(long number);
+        size_t print(unsigned long number);
+        size_t println();
+        template<typename T> size_t println(T value) { return print(value) + println(); }
+};
+
+/**
+ * stand-in for the hardware UART of the board
+ * Note: the receive side is an in-memory buffer which has to be filled by the host program
+ * using Feed(); everything written ends up in sent
+ * The line is simulated as infinitely fast: the receive FIFO of rxBufferSize bytes is always
+ * refilled as soon as it is read, so available() never reports more than rxBufferSize bytes.
+ */
+class HardwareSerial : public Print
+{
+    public:
+        void begin(unsigned long baud);
+        void end();
+        void setTimeout(unsigned long timeout);
+        size_t setRxBufferSize(size_t size);
+        void flush() {}
+        int available();
+        int read();
+        int peek();
+        /**
+         * function reading up to the given amount of bytes from the receive buffer
+         * Note: returns early with the bytes available as there is no data arriving while waiting
+         */
+        size_t readBytes(uint8_t* buffer, size_t length);
+        size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*) buffer, length); }
+        size_t write(uint8_t b);
+        size_t write(const uint8_t* buffer, size_t size);
+        using Print::write;
+        operator bool() const { return begun; }
+
+        //host side of the simulated UART
+        void Feed(const uint8_t* bytes, size_t length);
+        void Rewind() { readPosition = 0; }
+        void Clear();
+
+        //the bytes written by the device
+        std::vector<uint8_t> sent;
+        unsigned long baud = 0;
+        unsigned long timeout = 1000;
+        //the size of the receive FIFO, 256 bytes like the ESP32 core
+        size_t rxBufferSize = 256;
+
+    private:
+        bool begun = false;
+        std::vector<uint8_t> received;
+        size_t readPosition = 0;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,56 @@
+#include "FastLED.h"
+#include <chrono>
+#include <thread>
+
+CFastLED FastLED;
+
+void CLEDController::showLeds(uint8_t brightness)
+{
+    showCount++;
+    CFastLED::Wait((unsigned long) FastLED.ledDuration * ledCount);
+}
+
+void CFastLED::show()
+{
+    showCount++;
+    if(onShow)
+    {
+        onShow();
+    }
+    int largest = 0;
+    for(size_t i = 0; i < controllers.size(); i++)
+    {
+        controllers[i].showCount++;
+        largest = controllers[i].size() > largest ? controllers[i].size() : largest;
+    }
+    Wait(showDuration + (unsigned long) ledDuration * largest);
+}
+
+void CFastLED::Wait(unsigned long duration)
+{
+    if(duration == 0)
+    {
+        return;
+    }
+    if(HostClock::IsSimulated())
+    {
+        delayMicroseconds(duration);
+    }
+    else
+    {
+        //the leds are clocked out while the other threads keep running
+        std::this_thread::sleep_for(std::chrono::microseconds(duration));
+    }
+}
+
+void CFastLED::clear(bool writeData)
+{
+    for(size_t i = 0; i < controllers.size(); i++)
+    {
+        memset((void*) controllers[i].leds(), 0, controllers[i].size() * sizeof(CRGB));
+    }
+    if(writeData)
+    {
+        show();
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef ALUP_HOST_FASTLED_H
+#define ALUP_HOST_FASTLED_H
+
+/**
+ * minimal stand-in for the FastLED library which is used to build the ALUP library on a Linux host
+ * Note: only the parts of the FastLED API used by this library are provided
+ */
+
+#include "Arduino.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+
+/**
+ * an RGB color using 3 packed bytes, laid out like the FastLED CRGB
+ */
+struct CRGB
+{
+    union
+    {
+        struct
+        {
+            uint8_t r;
+            uint8_t g;
+            uint8_t b;
+        };
+        uint8_t raw[3];
+    };
+
+    CRGB() {}
+    CRGB(uint8_t _r, uint8_t _g, uint8_t _b) : r {_r}, g {_g}, b {_b} {}
+
+    bool operator==(const CRGB& other) const { return r == other.r && g == other.g && b == other.b; }
+    bool operator!=(const CRGB& other) const { return !(*this == other); }
+};
+
+enum EOrder
+{
+    RGB = 0012,
+    RBG = 0021,
+    GRB = 0102,
+    GBR = 0120,
+    BRG = 0201,
+    BGR = 0210
+};
+
+/**
+ * stand-in for the chipset controllers of FastLED
+ */
+template<uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2812B {};
+template<uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2812 {};
+template<uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2811 {};
+
+/**
+ * a registered led array
+ */
+class CLEDController
+{
+    public:
+        CLEDController(CRGB* _leds, int _ledCount) : ledArray {_leds}, ledCount {_ledCount} {}
+        CLEDController& setLeds(CRGB* _leds, int _ledCount)
+        {
+            ledArray = _leds;
+            ledCount = _ledCount;
+            return *this;
+        }
+        CRGB* leds() { return ledArray; }
+        int size() { return ledCount; }
+        /**
+         * function "showing" only the leds of this controller
+         * Note: takes CFastLED::ledDuration per led, see CFastLED::show()
+         */
+        void showLeds(uint8_t brightness = 255);
+
+        //the number of times the leds of this controller were shown, alone or by CFastLED::show()
+        unsigned long showCount = 0;
+
+    private:
+        CRGB* ledArray;
+        int ledCount;
+};
+
+class CFastLED
+{
+    public:
+        template<template<uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
+        CLEDController& addLeds(CRGB* leds, int ledCount)
+        {
+            controllers.push_back(CLEDController(leds, ledCount));
+            return controllers.back();
+        }
+
+        /**
+         * function "showing" the leds of all controllers
+         * Note: the data is not sent anywhere; the call takes showDuration plus ledDuration for each led
+         * of the largest controller, as the controllers are driven in parallel (like the RMT or I2S outputs
+         * of the ESP32). The time is slept in real time or added to the simulated time, see HostClock
+         */
+        void show();
+        /**
+         * function setting the leds of all controllers to black
+         * @param writeData: if true, the cleared leds are shown
+         */
+        void clear(bool writeData = false);
+        int count() { return controllers.size(); }
+        void setBrightness(uint8_t _brightness) { brightness = _brightness; }
+        uint8_t getBrightness() { return brightness; }
+        CLEDController& operator[](int index) { return controllers[index]; }
+
+        //the number of times show() was called
+        std::atomic<unsigned long> showCount {0};
+        //the time one call of show() takes in microseconds
+        unsigned int showDuration = 0;
+        //the additional time per led of a controller in microseconds
+        unsigned int ledDuration = 0;
+        //called by show() before the leds are "sent", e.g. to inspect the shown colors
+        std::function<void()> onShow;
+
+        /**
+         * function taking the given time, in real time or simulated
+         */
+        static void Wait(unsigned long duration);
+
+    private:
+        std::deque<CLEDController> controllers;
+        uint8_t brightness = 255;
+};
+
+extern CFastLED FastLED;
+
+#endif
@@ -9,27 +9,234 @@
 #define CONFIGURATION_ERROR_BYTE 251
 #define FRAME_ACKNOWLEDGEMENT_BYTE 250
 #define FRAME_ERROR_BYTE 249
+#define FRAME_CUMULATIVE_ACKNOWLEDGEMENT_BYTE 248
+#define CONFIGURATION_OPTION_BYTE 247
+#define TIME_SYNC_BYTE 246
+#define STATISTICS_BYTE 245
+#define BAUD_RATE_CONFIRMATION_BYTE 244
+#define SESSION_RESUME_BYTE 243
 
 #define PROTOCOL_VERSION "0.2"
 
+//the time between two connection requests in milliseconds
+#define CONNECTION_REQUEST_INTERVAL 20
+
+//the maximum size of a configuration option value; longer values are truncated
+#define CONFIGURATION_OPTION_MAX_LENGTH 64
+
+//the size of the stack buffer the configuration is built in; larger configurations are allocated
+#ifndef ALUP_CONFIGURATION_MAX_SIZE
+#define ALUP_CONFIGURATION_MAX_SIZE 128
+#endif
+
+//the maximum number of unacknowledged frames accepted when pipelining is negotiated
+#ifndef ALUP_MAX_PIPELINE_WINDOW
+#define ALUP_MAX_PIPELINE_WINDOW 32
+#endif
+
+//the maximum number of led strips which can be addressed by frames, see Alup::AddChannel()
+#ifndef ALUP_MAX_CHANNELS
+#define ALUP_MAX_CHANNELS 8
+#endif
+
+//frames with a presentation time further in the future are shown immediately, in microseconds
+#ifndef ALUP_MAX_PRESENTATION_DELAY
+#define ALUP_MAX_PRESENTATION_DELAY 5000000
+#endif
+
+//the bytes the master sends after switching the baud rate; the device answers with the same bytes
+#define BAUD_RATE_VERIFY_PATTERN {0x55, 0xAA, 0x00, 0xFF, 0x0F, 0xF0, 0x33, 0xCC, 0x01, 0x80, 0x7F, 0xFE, 0xA5, 0x5A, 0x69, 0x96}
+#define BAUD_RATE_VERIFY_PATTERN_SIZE 16
+//the size of the verification burst: the pattern repeated
+#define BAUD_RATE_VERIFY_SIZE (2 * BAUD_RATE_VERIFY_PATTERN_SIZE)
+//the time the device waits for the verification burst and the confirmation in milliseconds
+#define BAUD_RATE_VERIFY_TIMEOUT 100
+
+//the size of the answer to the CAPABILITIES option without the led counts of the channels: max body size,
+//free memory, supported commands, supported options (32 bit each), max pipeline window (1 byte),
+//min frame interval (32 bit) and the number of channels (1 byte)
+#define CAPABILITIES_SIZE 22
+
+//the time it takes to show one led in microseconds, used to estimate the min frame interval
+//clockless leds like the WS2812 need 30us; clocked leds (with a clock pin) like the APA102 about 3us
+#ifndef ALUP_CLOCKLESS_LED_TIME
+#define ALUP_CLOCKLESS_LED_TIME 30
+#endif
+#ifndef ALUP_CLOCKED_LED_TIME
+#define ALUP_CLOCKED_LED_TIME 3
+#endif
+//the time the leds need to latch the colors after a show in microseconds
+#ifndef ALUP_LED_LATCH_TIME
+#define ALUP_LED_LATCH_TIME 50
+#endif
+//the max refresh rate of clockless leds in Hz; the WS2812B may glitch if it is shown more often
+#ifndef ALUP_CLOCKLESS_MAX_REFRESH_RATE
+#define ALUP_CLOCKLESS_MAX_REFRESH_RATE 400
+#endif
+//the weight of the last show in the average show time: 1 / ALUP_SHOW_TIME_WEIGHT
+#define ALUP_SHOW_TIME_WEIGHT 8
+
+//the time the debug leds signal an error in milliseconds
+#define ERROR_SIGNAL_DURATION 250
+
+//FastLED drives the controllers of a show() in parallel on the ESP32 (RMT or I2S), so showing
+//several channels at once takes as long as showing the largest one
+#if defined(ESP32) || defined(ALUP_HOST)
+#define ALUP_PARALLEL_OUTPUT
+#endif
+
+//the size of the stack buffer used for frame bodies which are not read straight into the leds
+#define BODY_CHUNK_SIZE 64
+//the size of a run of a run length encoded body
+#define RUN_LENGTH_TOKEN_SIZE 4
+//the size of the header of a span of a delta encoded body
+#define DELTA_SPAN_HEADER_SIZE 4
+//the number of entries of the palette used by the palette commands
+#define PALETTE_SIZE 256
+//the size of a color of a RGB565 body
+#define RGB565_TOKEN_SIZE 2
+//the size of the two colors packed into 3 bytes of a RGB444 body
+#define RGB444_TOKEN_SIZE 3
+//the size of the header of a segment of a scatter body
+#define SCATTER_SEGMENT_HEADER_SIZE 6
+//the maximum body size of a TIME_SYNC frame: master time and clock offset
+#define TIME_SYNC_BODY_SIZE 8
+
+#include "ColorLut.h"
 #include "Connection.h"
 #include "Frame.h"
+#include "RenderPipeline.h"
+#include "Statistics.h"
 #include <FastLED.h>
 
-class Alup
+/**
+ * options a master can negotiate during the configuration exchange
+ */
+enum ConfigurationOption
+{
+  //the number of unacknowledged frames the master wants to send; 0 for stop-and-wait
+  PIPELINE_WINDOW = 1,
+  //a 32 bit mask of the commands the master wants to use; bit n enables the command with the value n
+  COMMANDS = 2,
+  //frames select a channel using the highest byte of their offset; the device answers with
+  //the number of channels followed by the 32 bit led count of each channel
+  CHANNELS = 3,
+  //frame offsets address a universe shared by several devices, e.g. using multicast; the value is
+  //the index of the first led of this device in the universe (32 bit) and if frames are acknowledged (1 byte)
+  UNIVERSE = 4,
+  //1 byte: 1 if each frame is preceded by a sync word and its header and body are followed by a CRC, else 0
+  FRAMING = 5,
+  //no value: the device answers with the baud rates it supports (32 bit each); 4 bytes: the baud rate to
+  //switch to, answered with the rate switched to (the current one if the requested rate is not supported)
+  BAUD_RATE = 6,
+  //any value: the device answers with its capabilities, see CAPABILITIES_SIZE
+  CAPABILITIES = 7,
+  //any value: the device answers with a token identifying the session (32 bit); a master answering a
+  //connection request with SESSION_RESUME_BYTE and this token resumes the session without the configuration
+  SESSION = 8,
+  //1 byte: 1 if the master sends each frame in datagrams preceded by a fragment header (see FrameReassembler)
+  //once the configuration was acknowledged, else 0; only accepted by datagram connections, e.g. UdpConnection
+  FRAGMENTATION = 9
+};
+
+/**
+ * a led strip which can be addressed by frames
+ */
+struct LedChannel
+{
+    CRGB* leds;
+    int ledCount;
+    //the controller showing only this strip; nullptr to show all strips using FastLED.show()
+    CLEDController* controller;
+};
+
+//the commands of ALUP v0.2 which are always enabled
+#define BASE_COMMANDS ((1UL << Command::NONE) | (1UL << Command::CLEAR) | (1UL << Command::DISCONNECT) | (1UL << Command::TOGGLE_INTERNAL_LED))
+//the commands using the palette
+#define PALETTE_COMMANDS ((1UL << Command::PALETTE_UPLOAD) | (1UL << Command::PALETTE_8) | (1UL << Command::PALETTE_4))
+//the commands sending colors with a reduced precision
+#define REDUCED_COLOR_COMMANDS ((1UL << Command::RGB565) | (1UL << Command::RGB444))
+//the additional commands which can be enabled using the COMMANDS option
+//enabling TIME_SYNC also enables FRAME_PRESENTATION_FLAG
+#define EXTENDED_COMMANDS ((1UL << Command::RUN_LENGTH) | (1UL << Command::DELTA) | PALETTE_COMMANDS | REDUCED_COLOR_COMMANDS | (1UL << Command::SCATTER) | (1UL << Command::TIME_SYNC) | (1UL << Command::STATISTICS) | (1UL << Command::COLOR_LUT))
+
+/**
+ * the number of leds of the selected channel, which is a constant if LED_COUNT is not 0
+ * Note: a base class of AlupBase so that the constant does not use any RAM
+ */
+template<int LED_COUNT>
+class LedCountStorage
+{
+    protected:
+        int LedCount() const
+        {
+            return LED_COUNT;
+        }
+        void SetLedCount(int)
+        {
+        }
+};
+
+template<>
+class LedCountStorage<0>
+{
+    protected:
+        int LedCount() const
+        {
+            return ledCount;
+        }
+        void SetLedCount(int count)
+        {
+            ledCount = count;
+        }
+
+    private:
+        int ledCount = 0;
+};
+
+/**
+ * the ALUP device, using a connection of the given type
+ * Calls to the connection are resolved at compile time if ConnectionT is a final class. The decoders of
+ * commands missing in SUPPORTED_COMMANDS are left out of the program; masters can not enable them.
+ * If LED_COUNT is not 0, the led count is a constant of the decoders and only channel 0 is stored.
+ * Note: use Alup for any Connection chosen at runtime, or StaticAlup
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS = EXTENDED_COMMANDS, int LED_COUNT = 0>
+class AlupBase : protected LedCountStorage<LED_COUNT>
 {
     public:
-        Alup(CRGB* leds, int ledCount, int dataPin, int clockPin);
-        Connection* connection;
+        AlupBase(CRGB* leds, int ledCount, int dataPin, int clockPin);
+        ConnectionT* connection;
         bool connected = false;
-        int Connect(Connection* _connection, String deviceName,  String extraValues);
+        int Connect(ConnectionT* _connection, const char* deviceName, const char* extraValues);
         void Disconnect();
         void Run();
+        int AddChannel(CLEDController* controller);
+        void SetMaxRefreshRate(uint32_t rate);
+        //the counters and stage timings, also sent to the master by the STATISTICS command
+        Statistics statistics;
+#ifdef ALUP_RENDER_PIPELINE
+        void UseRenderPipeline(RenderPipeline* pipeline);
+#endif
 
 
     protected:
+        //the led pins for debugging
+        enum DebugPin
+        {
+            BLUE_1 = 3,
+            BLUE_2 = 5,
+            GREEN = 6,
+            RED_1 = 10,
+            RED_2 = 11
+        };
+
+        using LedCountStorage<LED_COUNT>::LedCount;
+        using LedCountStorage<LED_COUNT>::SetLedCount;
+        //the number of channels which can be stored; channels can not be added if LED_COUNT is fixed
+        static constexpr int MAX_CHANNELS = LED_COUNT > 0 ? 1 : ALUP_MAX_CHANNELS;
+
         CRGB * leds;
-        int ledCount;
         int dataPin;
         int clockPin;
         
@@ -37,15 +244,257 @@ class Alup
 
         uint8_t ReadByte();
         void SendByte(uint8_t byte);
-        void RequestAlupConnection();
-        void Blink(int pin, int count, int blinkDelay);
-        int SendConfiguration(String deviceName, int dataPin, int clockPin, int ledCount, String extraValues);
-        int BuildConfiguration(byte*& buffer, String protocolVersion, String deviceName, int32_t dataPin, int32_t clockPin, int32_t ledCount, String extraValues);
-        Frame ReadFrame();
+        int ReadBytes(byte* buffer, int length);
+        void SendBytes(byte* bytes, int length);
+        int RequestAlupConnection();
+        void ResetOptions();
+        void SignalError(int pin);
+        int SendConfiguration(const char* deviceName, int dataPin, int clockPin, int ledCount, const char* extraValues);
+        int BuildConfiguration(byte* buffer, int size, const char* protocolVersion, const char* deviceName, int32_t dataPin, int32_t clockPin, int32_t ledCount, const char* extraValues);
+        void ReadConfigurationOption();
+        int ApplyConfigurationOption(uint8_t option, byte* value, int length, byte* answer);
+        int ApplyBaudRate(byte* value, int length, byte* answer);
+        int WriteChannelLayout(byte* buffer);
+        int WriteCapabilities(byte* buffer);
+        uint32_t FreeMemory();
+        uint32_t MinFrameInterval();
+        void SwitchBaudRate(long baud);
+        bool ReadBytesWithin(byte* buffer, int length, unsigned long timeout);
+        void ParseAvailable();
+        int Discard(int length);
+        Frame ParseFrameHeader(byte* buffer);
+        int BeginFrame(Frame& frame);
+        int PrepareColors(Frame frame);
+        int PrepareSlice(Frame frame);
+        int ReadBody(int available);
+        void DecodeChunk(byte* data, int length);
+        void DecodeRunLength(byte* data, int length);
+        void ApplyRun(byte* run);
+        void DecodeDelta(byte* data, int length);
+        void FinishFrame();
         int ApplyFrame(Frame frame);
-        int ApplyColors(Frame frame);
-        int32_t ReadInt32();
+        void ClearLeds();
+        void Show();
+        void SelectChannel(int channel);
+        void ShowChannels();
+        void ScheduleShow();
+        bool WrittenLeds(int32_t& start, int32_t& end, bool replaced);
+        void MarkDamaged();
+        void RepairDamaged();
+        void Present();
+        void CountShow(unsigned long start);
+        bool PresentPendingFrame();
+        int HeaderSize();
+        int FindSyncWord(int available);
+        bool CheckHeader(int size);
+        int ReadFrameCheck(int available);
+        void SynchronizeClock();
+        void SendStatistics();
+        void AcknowledgeFrame(Frame frame);
+        void ReportFrameError(Frame frame);
+        void SendPendingAcknowledgement();
+
+        //the negotiated number of unacknowledged frames; 0 if frames are acknowledged one by one
+        int pipelineWindow = 0;
+        //the number of applied frames which were not acknowledged yet
+        int pendingAcknowledgements = 0;
+        //the sequence number of the last applied frame
+        uint8_t lastSequence = 0;
+
+#ifdef ALUP_RENDER_PIPELINE
+        //presents the frames on another core if set
+        RenderPipeline* renderPipeline = nullptr;
+#endif
+
+        //the state of the frame parser used by Run()
+        enum ParserState
+        {
+            HEADER,
+            BODY
+        };
+        ParserState parserState = ParserState::HEADER;
+        //the bytes of the frame header received so far
+        byte headerBuffer[FRAME_HEADER_SIZE + PRESENTATION_TIME_SIZE + FRAME_CRC_SIZE];
+        int headerBytes = 0;
+        //the frame of which the body is being received
+        Frame frame;
+        //the result of BeginFrame() for the current frame
+        int frameResult = 0;
+        //if the data received after a header with an invalid length has to be dropped, see BeginFrame()
+        bool flushPending = false;
+        //the number of body bytes received so far
+        int32_t bodyBytesRead = 0;
+        //the number of body bytes which are read straight into rawTarget, starting with body byte rawBodyStart
+        int32_t rawBodyStart = 0;
+        int32_t rawBodyBytes = 0;
+        byte* rawTarget = nullptr;
+
+        //the decoder of the current frame body
+        enum BodyDecoder
+        {
+            DECODE_DISCARD,
+            DECODE_RAW,
+            DECODE_RUN_LENGTH,
+            DECODE_DELTA,
+            DECODE_PALETTE_8,
+            DECODE_PALETTE_4,
+            DECODE_RGB565,
+            DECODE_RGB444,
+            DECODE_SCATTER
+        };
+        BodyDecoder bodyDecoder = BodyDecoder::DECODE_DISCARD;
+        int PrepareEncodedColors(Frame frame, int tokenSize, BodyDecoder decoder);
+        int PreparePalette(Frame frame);
+        int PrepareColorLut(Frame frame);
+        int ApplyColorLut(Frame frame);
+        int AllocateColorLut();
+        void CorrectColors(byte* bytes, int32_t length, int color);
+        void DecodePalette8(byte* data, int length);
+        void DecodePalette4(byte* data, int length);
+        int AllocatePalette();
+        void DecodeRgb565(byte* data, int length);
+        void DecodeRgb444(byte* data, int length);
+        int CompleteToken(byte* data, int length, int tokenSize);
+        void DecodeScatter(byte* data, int length);
+        //the colors used by the palette commands; allocated once they are enabled
+        CRGB* palette = nullptr;
+        //the lookup tables applied to decoded colors; allocated once COLOR_LUT is enabled
+        ColorLut* colorLut = nullptr;
+        //the tables the body of a COLOR_LUT frame is received into, swapped with colorLut once the frame is complete
+        ColorLut* stagedColorLut = nullptr;
+        //if colorLut is applied; false while it is the identity
+        bool colorLutEnabled = false;
+        //if the raw colors of the current frame are read into the leds, so that colorLut is applied to them
+        bool rawColors = false;
+        //the brightness set by the sketch before the master changed it; -1 if it was not changed
+        int16_t sketchBrightness = -1;
+        //the index of the next led written by the decoder
+        int32_t decodeLed = 0;
+        //the index of the first led written by the decoder
+        int32_t decodeStart = 0;
+        //the index of the next led byte changed by the delta and scatter decoders
+        int32_t decodePosition = 0;
+        //a token (run, color or span header) split between two chunks of the body
+        byte token[SCATTER_SEGMENT_HEADER_SIZE];
+        int tokenBytes = 0;
+        //the number of bytes left of the current delta span or scatter segment
+        int32_t spanRemaining = 0;
+        //the commands which can be used by the master, see ConfigurationOption::COMMANDS
+        uint32_t enabledCommands = BASE_COMMANDS;
+
+        //the led strips; channel 0 is the one given to the constructor
+        LedChannel channels[MAX_CHANNELS];
+        int channelCount = 1;
+        //if frames select a channel, see ConfigurationOption::CHANNELS
+        bool channelsEnabled = false;
+        //the channel of the current frame
+        int frameChannel = 0;
+        //the channels which were changed but not shown yet; bit n is channel n
+        uint32_t dirtyChannels = 0;
+        //the channels holding colors of a corrupted frame body, which are not shown until rewritten; bit n is channel n
+        uint32_t damagedChannels = 0;
+        //the leds of each damaged channel which may hold corrupted colors
+        int32_t damagedStart[MAX_CHANNELS];
+        int32_t damagedEnd[MAX_CHANNELS];
+        //the max refresh rate set by SetMaxRefreshRate() in Hz; 0 to derive it from the led type
+        uint32_t maxRefreshRate = 0;
+        //the time the next show may start, in local time
+        unsigned long nextShowAt = 0;
+        //the moving average of the time a show took in microseconds; 0 until a show was measured
+        uint32_t averageShowTime = 0;
+
+        //if frame offsets address a universe, see ConfigurationOption::UNIVERSE
+        bool universeEnabled = false;
+        //the index of the first led of this device in the universe
+        int32_t universeStart = 0;
+        //if the current frame does not change any led of this device
+        bool frameOutsideSlice = false;
+        //if frames are answered; masters sending to many devices at once may not want acknowledgements
+        bool acknowledgeFrames = true;
+
+        //the body of the current TIME_SYNC frame
+        byte timeSyncBody[TIME_SYNC_BODY_SIZE];
+        //the difference of the local clock to the master clock in microseconds, set by TIME_SYNC frames
+        int32_t clockOffset = 0;
+        //if an applied frame waits for its presentation time, in local time
+        bool presentationPending = false;
+        unsigned long presentAt = 0;
+        //if the frame waiting for its presentation time is acknowledged once it is shown
+        bool acknowledgementDeferred = false;
+        //the time the last timestamped frame was shown after its presentation time in microseconds
+        int32_t lastSkew = 0;
+
+        //if frames are framed by a sync word and CRCs, see ConfigurationOption::FRAMING
+        bool framingEnabled = false;
+        //the number of bytes of the sync word found so far
+        int syncBytes = 0;
+        //the CRC of the header and the body bytes read so far
+        uint16_t frameCrc = FRAME_CRC_INIT;
+        //the CRC received after the body
+        byte frameCheck[FRAME_CRC_SIZE];
+        int checkBytes = 0;
+        //the sequence number expected for the next frame; reported if a header is corrupted
+        uint8_t nextSequence = 0;
+
+        //the token of the session which can be resumed; 0 if none was issued, see ConfigurationOption::SESSION
+        uint32_t sessionToken = 0;
+        //if frames are received in fragments once connected, see ConfigurationOption::FRAGMENTATION
+        bool fragmentationEnabled = false;
+        //if the debug leds were tested by the first Connect()
+        bool debugLedsTested = false;
+
+        //the baud rate accepted by the last configuration option; switched to once the answer was sent
+        long pendingBaudRate = 0;
+
+        //the time the first header byte of the current frame was read, see Statistics
+        unsigned long frameStart = 0;
+        //the time spent reading and decoding the encoded body of the current frame
+        unsigned long frameDecodeTime = 0;
+
+        //if a debug led signals an error until errorSignalEnd (millis()), see SignalError()
+        bool errorSignaled = false;
+        unsigned long errorSignalEnd = 0;
         
 };
 
+#include "ALUPImpl.h"
+
+//compiled once in ALUP.cpp
+extern template class AlupBase<Connection>;
+
+/**
+ * the ALUP device using any connection; all commands are supported
+ */
+class Alup : public AlupBase<Connection>
+{
+    public:
+        Alup(CRGB* leds, int ledCount, int dataPin, int clockPin);
+        int Connect(Connection* _connection, String deviceName, String extraValues);
+};
+
+/**
+ * the ALUP device for a connection type, led count and set of commands known at compile time
+ * Note: mark the connection class final so that its functions can be inlined into the parser
+ * @param ConnectionT: the type of the connection, e.g. SerialConnection
+ * @param LED_COUNT: the size of the led array; additional channels can not be added
+ * @param SUPPORTED_COMMANDS: the commands masters can enable, see EXTENDED_COMMANDS
+ */
+template<class ConnectionT, int LED_COUNT, uint32_t SUPPORTED_COMMANDS = EXTENDED_COMMANDS>
+class StaticAlup : public AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>
+{
+    static_assert(LED_COUNT > 0 && LED_COUNT <= 0x00FFFFFF, "LED_COUNT has to be addressable by a frame offset");
+    static_assert((SUPPORTED_COMMANDS & ~EXTENDED_COMMANDS) == 0, "SUPPORTED_COMMANDS may only contain EXTENDED_COMMANDS");
+
+    public:
+        /**
+         * default constructor
+         * @param _leds: the led array used by FastLED
+         * @param _dataPin: the data pin used by FastLED
+         * @param _clockPin: the clock pin used by FastLED
+         */
+        StaticAlup(CRGB (&_leds)[LED_COUNT], int _dataPin, int _clockPin) : AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>(_leds, LED_COUNT, _dataPin, _clockPin)
+        {
+        }
+};
+
 #endif
@@ -0,0 +1,2530 @@
+#ifndef ALUP_IMPL_H
+#define ALUP_IMPL_H
+
+//the definitions of the AlupBase template; included by ALUP.h
+
+#include "Convert.h"
+#include "Log.h"
+
+//frame bodies are read directly into the led array
+static_assert(sizeof(CRGB) == 3, "CRGB has to consist of 3 packed bytes");
+//the answer to the CHANNELS option has to fit into an option value
+static_assert(1 + 4 * ALUP_MAX_CHANNELS <= CONFIGURATION_OPTION_MAX_LENGTH, "too many channels");
+//the same goes for the answer to the CAPABILITIES option
+static_assert(CAPABILITIES_SIZE + 4 * ALUP_MAX_CHANNELS <= CONFIGURATION_OPTION_MAX_LENGTH, "too many channels for the capabilities");
+static_assert(ALUP_MAX_CHANNELS <= 32, "the dirty channels are stored in 32 bits");
+
+/**
+ * default constructor
+ * @param _leds: the led array used by FastLED
+ * @param _ledCount: the size of _leds
+ * @param _dataPin: the data pin used by FastLED
+ * @param _clockPin: the clock pin used by FastLED
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::AlupBase(CRGB* _leds, int _ledCount, int _dataPin, int _clockPin) : leds {_leds}, dataPin {_dataPin}, clockPin {_clockPin}
+{
+    SetLedCount(_ledCount);
+    channels[0] = {_leds, _ledCount, nullptr};
+}
+
+/**
+ * function adding a led strip which can be addressed by frames as an additional channel
+ * Frames select the channel using the highest byte of their offset once the master negotiated
+ * ConfigurationOption::CHANNELS. Only the channels changed by the frames of one Run() are shown;
+ * the leds of channel 0 (given to the constructor) are shown using FastLED.show().
+ * Note: not supported together with a render pipeline
+ * @param controller: the controller returned by FastLED.addLeds() for the strip
+ * @return: the number of the channel; -1 if ALUP_MAX_CHANNELS is reached, or always if LED_COUNT is fixed
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::AddChannel(CLEDController* controller)
+{
+    if(channelCount >= MAX_CHANNELS)
+    {
+        return -1;
+    }
+    channels[channelCount] = {controller->leds(), controller->size(), controller};
+    return channelCount++;
+}
+
+/**
+ * function limiting how often the leds are shown
+ * Frames applied faster are merged: the leds are shown once with the colors of the last of them.
+ * By default, clockless leds (no clock pin) are shown at most ALUP_CLOCKLESS_MAX_REFRESH_RATE times
+ * per second and clocked leds as often as a show allows, see MinFrameInterval().
+ * @param rate: the max refresh rate in Hz; 0 to derive it from the led type
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::SetMaxRefreshRate(uint32_t rate)
+{
+    maxRefreshRate = rate;
+}
+
+
+/**
+ * function esablishing an ALUP connection
+ * @param _connection: a connection object to use for the protocol
+ * @param deviceName: a name for this device
+ * @param dataPin: the data Pin of the LED strip; 0 if not used
+ * @param clockPin: the clock pin of the LED strip; 0 if not used
+ * @param ledCount: the number of LEDs on the led strip
+ * @param extraValues: additional configuration values to send, "" if not used
+ * @return: 1 if connected successfully, else 0
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::Connect(ConnectionT* _connection, const char* deviceName, const char* extraValues)
+{
+    //initialize debugging LEDs
+    //TODO: remove
+    pinMode(2, OUTPUT);
+    pinMode(BLUE_1, OUTPUT);
+    pinMode(BLUE_2, OUTPUT);
+    pinMode(GREEN, OUTPUT);
+    pinMode(RED_1, OUTPUT);
+    pinMode(RED_2,OUTPUT);
+
+    //test all leds once; reconnecting should not be delayed
+    if(!debugLedsTested)
+    {
+        digitalWrite(BLUE_1, HIGH);
+        delay(80);
+        digitalWrite(BLUE_2, HIGH);
+        delay(80);
+        digitalWrite(GREEN, HIGH);
+        delay(80);
+        digitalWrite(RED_1, HIGH);
+        delay(80);
+        digitalWrite(RED_2, HIGH);
+        delay(80);
+        debugLedsTested = true;
+    }
+
+    digitalWrite(2, LOW);
+    digitalWrite(BLUE_1, LOW);
+    digitalWrite(BLUE_2, LOW);
+    digitalWrite(GREEN, LOW);
+    digitalWrite(RED_1, LOW);
+    digitalWrite(RED_2, LOW);
+
+    //establish the data connection
+    connection = _connection;
+    connection->Connect();
+
+    //discard partially received frames of a previous connection
+    parserState = ParserState::HEADER;
+    headerBytes = 0;
+    pendingAcknowledgements = 0;
+    dirtyChannels = 0;
+    damagedChannels = 0;
+    nextShowAt = micros();
+    SelectChannel(0);
+    presentationPending = false;
+    acknowledgementDeferred = false;
+    syncBytes = 0;
+
+    //request alup connection until an answer is received
+    if(RequestAlupConnection())
+    {
+        //the master resumed the last session; its options still apply
+        connection->SetFragmentation(fragmentationEnabled);
+        connected = true;
+        statistics.connections++;
+        return 1;
+    }
+
+    //connection established
+    //start a new session: send the configuration and evaluate the response
+    ResetOptions();
+    if(!SendConfiguration(deviceName, dataPin, clockPin, LedCount(), extraValues))
+    {
+        connected = false;
+        return 0;
+    }
+
+    //the master sends fragments from now on
+    connection->SetFragmentation(fragmentationEnabled);
+    connected = true;
+    statistics.connections++;
+    return 1;
+}
+
+/**
+ * function sending connection requests every CONNECTION_REQUEST_INTERVAL until the master answers
+ * The master acknowledges a request to start a new session, or resumes the last session by answering
+ * with SESSION_RESUME_BYTE followed by the token of the session (32 bit), which is echoed by this device.
+ * Note: this function is blocking until an answer is received
+ * @return: 1 if the last session was resumed, 0 if the configuration has to be exchanged
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::RequestAlupConnection()
+{
+    unsigned long lastRequest = millis() - CONNECTION_REQUEST_INTERVAL;
+    int resumed = 0;
+    while(true)
+    {
+        if(millis() - lastRequest >= CONNECTION_REQUEST_INTERVAL)
+        {
+            //blink while waiting without delaying the requests
+            digitalWrite(BLUE_1, (millis() / 200) % 2);
+            SendByte(CONNECTION_REQUEST_BYTE);
+            lastRequest = millis();
+        }
+        //check if there is something to read
+        if(connection->Available() <= 0)
+        {
+            delay(1);
+            continue;
+        }
+        //read in the byte and check it for an acknowledgement
+        byte answer = ReadByte();
+        if(answer == CONNECTION_ACKNOWLEDGEMENT_BYTE)
+        {
+            break;
+        }
+        if(answer == SESSION_RESUME_BYTE)
+        {
+            byte resume[5];
+            resume[0] = SESSION_RESUME_BYTE;
+            ReadBytes(&resume[1], 4);
+            if(sessionToken != 0 && (uint32_t) Convert::BytesToInt32(&resume[1]) == sessionToken)
+            {
+                SendBytes(resume, 5);
+                resumed = 1;
+            }
+            //an unknown session is answered with the configuration of a new one
+            break;
+        }
+    }
+    digitalWrite(BLUE_1, LOW);
+    return resumed;
+}
+
+/**
+ * function building and sending the configuration to the slave device  
+ * @param deviceName: a name for this device
+ * @param dataPin: the data Pin of the LED strip; 0 if not used
+ * @param clockPin: the clock pin of the LED strip; 0 if not used
+ * @param ledCount: the number of LEDs on the led strip
+ * @param extraValues: additional configuration values to send, "" if not used
+ * @return: 1 if configuration was sent successfully, else 0
+ * Note: Blocks until an answer to the configuration is received
+ * Note: configurations larger than ALUP_CONFIGURATION_MAX_SIZE are built in an allocated buffer
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::SendConfiguration(const char* deviceName, int dataPin, int clockPin, int ledCount, const char* extraValues)
+{
+    //build the configuration
+    byte buff[ALUP_CONFIGURATION_MAX_SIZE];
+    byte* configuration = buff;
+    int length = BuildConfiguration(buff, sizeof(buff), PROTOCOL_VERSION, deviceName, dataPin, clockPin, ledCount, extraValues);
+    if(length > (int) sizeof(buff))
+    {
+        //the device name and extra values are too long for the stack buffer
+        configuration = (byte*) malloc(length);
+        if(configuration == nullptr)
+        {
+            ALUP_LOG_ERROR("Could not allocate the configuration of ", length, " bytes");
+            return 0;
+        }
+        BuildConfiguration(configuration, length, PROTOCOL_VERSION, deviceName, dataPin, clockPin, ledCount, extraValues);
+    }
+
+    //send the configuration
+    SendBytes(configuration, length);
+    if(configuration != buff)
+    {
+        free(configuration);
+    }
+
+    //wait for the response
+    while(true)
+    {
+        byte byte = ReadByte();
+        if(byte == CONFIGURATION_ACKNOWLEDGEMENT_BYTE)
+        {
+            //configuration exchanged successfully
+            //continue normally
+            return 1;
+        }
+        else if (byte == CONFIGURATION_ERROR_BYTE)
+        {
+            //configuration exchange failed
+            //abort the connection process 
+            return 0;
+        }
+        else if (byte == CONFIGURATION_OPTION_BYTE)
+        {
+            //the master negotiates an optional feature
+            ReadConfigurationOption();
+        }
+    }
+}
+
+/**
+ * function reading a configuration option requested by the master and answering it
+ * The request and the answer are both sent as:
+ * CONFIGURATION_OPTION_BYTE, option, value length, value
+ * where the answer contains the value accepted by this device; a length of 0 if the option is unknown
+ * Note: blocks until the option was read
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ReadConfigurationOption()
+{
+    byte option = ReadByte();
+    int length = ReadByte();
+
+    //read the value, discarding what exceeds the maximum length
+    byte value[CONFIGURATION_OPTION_MAX_LENGTH];
+    int valueLength = length > CONFIGURATION_OPTION_MAX_LENGTH ? CONFIGURATION_OPTION_MAX_LENGTH : length;
+    ReadBytes(value, valueLength);
+    for(int i = valueLength; i < length; i++)
+    {
+        ReadByte();
+    }
+
+    //apply the option and answer with the accepted value
+    byte answer[3 + CONFIGURATION_OPTION_MAX_LENGTH];
+    answer[0] = CONFIGURATION_OPTION_BYTE;
+    answer[1] = option;
+    answer[2] = ApplyConfigurationOption(option, value, valueLength, &answer[3]);
+    SendBytes(answer, 3 + answer[2]);
+
+    if(pendingBaudRate != 0)
+    {
+        //the answer was sent using the previous rate
+        SwitchBaudRate(pendingBaudRate);
+        pendingBaudRate = 0;
+    }
+}
+
+/**
+ * function applying a configuration option requested by the master
+ * @param option: the requested option, see ConfigurationOption
+ * @param value: the requested value of the option
+ * @param length: the length of the value
+ * @param answer: buffer for the accepted value; has a size of CONFIGURATION_OPTION_MAX_LENGTH
+ * @return: the length of the accepted value; 0 if the option is not supported
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ApplyConfigurationOption(uint8_t option, byte* value, int length, byte* answer)
+{
+    switch(option)
+    {
+        case ConfigurationOption::PIPELINE_WINDOW:
+            if(length < 1)
+            {
+                return 0;
+            }
+            pipelineWindow = value[0] > ALUP_MAX_PIPELINE_WINDOW ? ALUP_MAX_PIPELINE_WINDOW : value[0];
+            answer[0] = pipelineWindow;
+            return 1;
+
+        case ConfigurationOption::COMMANDS:
+            if(length < 4)
+            {
+                return 0;
+            }
+            //enable the requested commands which are supported
+            enabledCommands = BASE_COMMANDS | ((uint32_t) Convert::BytesToInt32(value) & EXTENDED_COMMANDS & SUPPORTED_COMMANDS);
+            if((SUPPORTED_COMMANDS & PALETTE_COMMANDS) && (enabledCommands & PALETTE_COMMANDS) && !AllocatePalette())
+            {
+                //not enough memory left for the palette
+                enabledCommands &= ~PALETTE_COMMANDS;
+            }
+            if((SUPPORTED_COMMANDS & (1UL << Command::COLOR_LUT)) && (enabledCommands & (1UL << Command::COLOR_LUT)) && !AllocateColorLut())
+            {
+                //not enough memory left for the lookup tables
+                enabledCommands &= ~(1UL << Command::COLOR_LUT);
+            }
+            Convert::Int32ToBytes(enabledCommands, answer);
+            return 4;
+
+        case ConfigurationOption::CHANNELS:
+            channelsEnabled = true;
+            return WriteChannelLayout(answer);
+
+        case ConfigurationOption::UNIVERSE:
+            if(length < 5)
+            {
+                return 0;
+            }
+            universeEnabled = true;
+            universeStart = Convert::BytesToInt32(value);
+            if(universeStart < 0)
+            {
+                universeStart = 0;
+            }
+            acknowledgeFrames = value[4] != 0;
+            Convert::Int32ToBytes(universeStart, answer);
+            answer[4] = acknowledgeFrames;
+            return 5;
+
+        case ConfigurationOption::FRAMING:
+            if(length < 1)
+            {
+                return 0;
+            }
+            framingEnabled = value[0] == 1;
+            answer[0] = framingEnabled;
+            return 1;
+
+        case ConfigurationOption::BAUD_RATE:
+            return ApplyBaudRate(value, length, answer);
+
+        case ConfigurationOption::CAPABILITIES:
+            return WriteCapabilities(answer);
+
+        case ConfigurationOption::SESSION:
+            //the token only has to differ from the ones of earlier sessions
+            sessionToken = (uint32_t) ((uint32_t) micros() * 2654435761UL) ^ (statistics.connections << 16);
+            if(sessionToken == 0)
+            {
+                sessionToken = 1;
+            }
+            Convert::Int32ToBytes(sessionToken, answer);
+            return 4;
+
+        case ConfigurationOption::FRAGMENTATION:
+            if(length < 1)
+            {
+                return 0;
+            }
+            //applied once the configuration was acknowledged
+            fragmentationEnabled = value[0] == 1 && connection->SupportsFragmentation();
+            answer[0] = fragmentationEnabled;
+            return 1;
+
+        default:
+            //unknown option
+            return 0;
+    }
+}
+
+
+/**
+ * function writing the number of channels followed by the led count of each channel (32 bit each)
+ * @param buffer: the buffer to write to; has to have a size of 1 + 4 * ALUP_MAX_CHANNELS
+ * @return: the number of bytes written
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::WriteChannelLayout(byte* buffer)
+{
+    //the render pipeline only presents channel 0
+    int count = channelCount;
+#ifdef ALUP_RENDER_PIPELINE
+    if(renderPipeline != nullptr)
+    {
+        count = 1;
+    }
+#endif
+    buffer[0] = count;
+    for(int i = 0; i < count; i++)
+    {
+        Convert::Int32ToBytes(channels[i].ledCount, &buffer[1 + 4 * i]);
+    }
+    return 1 + 4 * count;
+}
+
+/**
+ * function writing the answer to the CAPABILITIES option:
+ * the max body size of a raw frame, the free memory for buffers, the supported commands and options
+ * (bit n is the command or option with the value n), the max pipeline window, the min frame interval
+ * and the channel layout, see WriteChannelLayout()
+ * Note: masters pick the options and commands to negotiate from it; it does not enable anything
+ * @param buffer: the buffer to write to; has a size of CONFIGURATION_OPTION_MAX_LENGTH
+ * @return: the number of bytes written
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::WriteCapabilities(byte* buffer)
+{
+    //a frame body covers at most one channel
+    int32_t maxLeds = 0;
+    for(int i = 0; i < channelCount; i++)
+    {
+        maxLeds = channels[i].ledCount > maxLeds ? channels[i].ledCount : maxLeds;
+    }
+
+    uint32_t options = (1UL << ConfigurationOption::PIPELINE_WINDOW) | (1UL << ConfigurationOption::COMMANDS) | (1UL << ConfigurationOption::CHANNELS)
+        | (1UL << ConfigurationOption::UNIVERSE) | (1UL << ConfigurationOption::FRAMING) | (1UL << ConfigurationOption::CAPABILITIES)
+        | (1UL << ConfigurationOption::SESSION);
+    long rates[1];
+    if(connection->GetBaudRates(rates, 1) > 0)
+    {
+        options |= 1UL << ConfigurationOption::BAUD_RATE;
+    }
+    if(connection->SupportsFragmentation())
+    {
+        options |= 1UL << ConfigurationOption::FRAGMENTATION;
+    }
+
+    int length = 0;
+    length += Convert::Int32ToBytes(3 * maxLeds, &buffer[length]);
+    length += Convert::Int32ToBytes(FreeMemory(), &buffer[length]);
+    length += Convert::Int32ToBytes(BASE_COMMANDS | (EXTENDED_COMMANDS & SUPPORTED_COMMANDS), &buffer[length]);
+    length += Convert::Int32ToBytes(options, &buffer[length]);
+    buffer[length++] = ALUP_MAX_PIPELINE_WINDOW;
+    length += Convert::Int32ToBytes(MinFrameInterval(), &buffer[length]);
+    length += WriteChannelLayout(&buffer[length]);
+    return length;
+}
+
+/**
+ * function returning the size of the largest block of memory which can still be allocated,
+ * e.g. for the palette or frame buffers of the master
+ * @return: the size in bytes; 0 if it is unknown on this board
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+uint32_t AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::FreeMemory()
+{
+#if defined(ESP32)
+    return ESP.getMaxAllocHeap();
+#elif defined(ESP8266)
+    return ESP.getMaxFreeBlockSize();
+#elif defined(__AVR__)
+    //the gap between the heap and the stack
+    extern char __heap_start;
+    extern char* __brkval;
+    char top;
+    return &top - (__brkval == nullptr ? &__heap_start : __brkval);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * function returning the shortest time between two frames the leds can show
+ * The time a show takes is the average of the last shows once the leds were shown, else estimated
+ * from the led count using ALUP_CLOCKLESS_LED_TIME or ALUP_CLOCKED_LED_TIME. It is at least the
+ * interval of the max refresh rate, see SetMaxRefreshRate().
+ * @return: the time in microseconds; 1000000 divided by it is the max refresh rate
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+uint32_t AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::MinFrameInterval()
+{
+    uint32_t rate = maxRefreshRate;
+    if(rate == 0 && clockPin == 0)
+    {
+        rate = ALUP_CLOCKLESS_MAX_REFRESH_RATE;
+    }
+    uint32_t rateInterval = rate > 0 ? 1000000 / rate : 0;
+
+    if(averageShowTime > 0)
+    {
+        return averageShowTime > rateInterval ? averageShowTime : rateInterval;
+    }
+
+    //the channels are shown one after another unless they are shown in parallel
+    uint32_t ledTime = clockPin != 0 ? ALUP_CLOCKED_LED_TIME : ALUP_CLOCKLESS_LED_TIME;
+    uint32_t showTime = 0;
+    for(int i = 0; i < channelCount; i++)
+    {
+#ifdef ALUP_PARALLEL_OUTPUT
+        showTime = channels[i].ledCount * ledTime > showTime ? channels[i].ledCount * ledTime : showTime;
+#else
+        showTime += channels[i].ledCount * ledTime;
+#endif
+    }
+    showTime += ALUP_LED_LATCH_TIME;
+    return showTime > rateInterval ? showTime : rateInterval;
+}
+
+/**
+ * function answering the baud rate option
+ * @param value: no value to ask for the supported rates, else the requested rate (32 bit)
+ * @param length: the length of the value
+ * @param answer: buffer for the answer; has a size of CONFIGURATION_OPTION_MAX_LENGTH
+ * @return: the length of the answer; 0 if the connection can not change its baud rate
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ApplyBaudRate(byte* value, int length, byte* answer)
+{
+    long rates[CONFIGURATION_OPTION_MAX_LENGTH / 4];
+    int count = connection->GetBaudRates(rates, CONFIGURATION_OPTION_MAX_LENGTH / 4);
+    if(count == 0)
+    {
+        return 0;
+    }
+    if(length < 4)
+    {
+        //answer the supported rates
+        for(int i = 0; i < count; i++)
+        {
+            Convert::Int32ToBytes(rates[i], &answer[4 * i]);
+        }
+        return 4 * count;
+    }
+
+    //accept the requested rate if it is supported, else keep the current one
+    long requested = Convert::BytesToInt32(value);
+    long current = connection->GetBaudRate();
+    for(int i = 0; i < count; i++)
+    {
+        if(rates[i] == requested && requested != current)
+        {
+            pendingBaudRate = requested;
+        }
+    }
+    Convert::Int32ToBytes(pendingBaudRate != 0 ? pendingBaudRate : current, answer);
+    return 4;
+}
+
+/**
+ * function switching to the given baud rate and verifying it with the master
+ * After switching, the master sends BAUD_RATE_VERIFY_SIZE bytes of BAUD_RATE_VERIFY_PATTERN which are echoed,
+ * followed by BAUD_RATE_CONFIRMATION_BYTE once the master received the echo. If any of them is missing
+ * within BAUD_RATE_VERIFY_TIMEOUT or wrong, the previous rate is used again; the master does the same
+ * and waits BAUD_RATE_VERIFY_TIMEOUT before sending anything else.
+ * Note: blocks for up to 2 * BAUD_RATE_VERIFY_TIMEOUT
+ * @param baud: the new baud rate
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::SwitchBaudRate(long baud)
+{
+    long previous = connection->GetBaudRate();
+    if(!connection->SetBaudRate(baud))
+    {
+        return;
+    }
+
+    const byte pattern[] = BAUD_RATE_VERIFY_PATTERN;
+    byte burst[BAUD_RATE_VERIFY_SIZE];
+    if(ReadBytesWithin(burst, BAUD_RATE_VERIFY_SIZE, BAUD_RATE_VERIFY_TIMEOUT))
+    {
+        bool valid = true;
+        for(int i = 0; i < BAUD_RATE_VERIFY_SIZE; i++)
+        {
+            valid = valid && burst[i] == pattern[i % BAUD_RATE_VERIFY_PATTERN_SIZE];
+        }
+        byte confirmation = 0;
+        if(valid)
+        {
+            SendBytes(burst, BAUD_RATE_VERIFY_SIZE);
+            if(ReadBytesWithin(&confirmation, 1, BAUD_RATE_VERIFY_TIMEOUT) && confirmation == BAUD_RATE_CONFIRMATION_BYTE)
+            {
+                //both sides use the new rate
+                return;
+            }
+        }
+    }
+
+    //fall back and discard what was received using the wrong rate
+    connection->SetBaudRate(previous);
+    while(connection->Available() > 0)
+    {
+        ReadByte();
+    }
+}
+
+/**
+ * function reading the given amount of bytes unless they are not received in time
+ * @param buffer: a buffer of the given length
+ * @param length: the number of bytes to read
+ * @param timeout: the time to wait for the bytes in milliseconds
+ * @return: true if the bytes were read, false if they were not received in time
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+bool AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ReadBytesWithin(byte* buffer, int length, unsigned long timeout)
+{
+    unsigned long start = millis();
+    while(connection->Available() < length)
+    {
+        if(millis() - start >= timeout)
+        {
+            return false;
+        }
+        delay(1);
+    }
+    ReadBytes(buffer, length);
+    return true;
+}
+
+/**
+ * function writing the configuration containing the given values into the given buffer
+ * @param buffer: the buffer in which the result will be stored
+ * @param size: the size of the buffer
+ * @param protocolVersion: the protcol version of this implementation. Usually PROTOCOL_VERSION
+ * @param deviceName: a name for this device
+ * @param dataPin: the data Pin of the LED strip; 0 if not used
+ * @param clockPin: the clock pin of the LED strip; 0 if not used
+ * @param ledCount: the number of LEDs on the led strip
+ * @param extraValues: additional configuration values to send, "" if not used
+ * @return: the size of the configuration; nothing is written if it exceeds the size of the buffer
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::BuildConfiguration(byte* buffer, int size, const char* protocolVersion, const char* deviceName, int32_t dataPin, int32_t clockPin, int32_t ledCount, const char* extraValues)
+{
+    //the lengths of the strings including their null terminators
+    int versionLength = strlen(protocolVersion) + 1;
+    int nameLength = strlen(deviceName) + 1;
+    int extraValuesLength = strlen(extraValues) + 1;
+
+    //add one byte for the configuration start
+    int configurationSize = 1 + versionLength + nameLength + extraValuesLength + sizeof(int32_t) * 3;
+    if(configurationSize > size)
+    {
+        return configurationSize;
+    }
+    buffer[0] = CONFIGURATION_START_BYTE;
+
+    //concatenate all values
+    int offset = 1;
+    //copy the protcol version
+    memcpy(&buffer[offset], protocolVersion, versionLength);
+    offset += versionLength;
+    //copy the device name
+    memcpy(&buffer[offset], deviceName, nameLength);
+    offset += nameLength;
+    //copy the led count
+    Convert::Int32ToBytes(ledCount, &buffer[offset]);
+    offset += 4;
+    //copy the data pin
+    Convert::Int32ToBytes(dataPin, &buffer[offset]);
+    offset += 4;
+    //copy the clock pin
+    Convert::Int32ToBytes(clockPin, &buffer[offset]);
+    offset += 4;
+    //copy the extra values
+    memcpy(&buffer[offset], extraValues, extraValuesLength);
+
+    return configurationSize;
+}
+
+/**
+ * function reading a single byte from the connection
+ * @return: the byte read from the connection
+ * Note: This function is blocking until a byte was read
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+byte AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ReadByte()
+{
+    byte buff[1];
+    ReadBytes(buff, 1);
+    return buff[0];
+}
+
+
+/**
+ * function sending a single byte from the connection
+ * @param b: the byte to send
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::SendByte(byte b)
+{
+    //send the data
+    byte buff[] = {b};
+    SendBytes(buff, 1);
+}
+
+/**
+ * function reading the given amount of bytes from the connection
+ * The bytes are added to the statistics.
+ * @param buffer: a buffer for the bytes; has to have the given size
+ * @param length: the number of bytes to read
+ * @return: the number of bytes read
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ReadBytes(byte* buffer, int length)
+{
+    int read = connection->Read(buffer, length);
+    if(read > 0)
+    {
+        statistics.bytesReceived += read;
+    }
+    return read;
+}
+
+/**
+ * function sending the given bytes over the connection and adding them to the statistics
+ * @param bytes: the bytes to send
+ * @param length: the number of bytes
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::SendBytes(byte* bytes, int length)
+{
+    connection->Send(bytes, length);
+    statistics.bytesSent += length;
+}
+
+
+
+
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::Disconnect()
+{
+    connection->Disconnect();
+    connected = false;
+    //the master ended the session
+    ResetOptions();
+}
+
+/**
+ * function ending the session: the negotiated options are reset to the behaviour of v0.2
+ * Note: options last for a session, which may span several connections, see ConfigurationOption::SESSION
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ResetOptions()
+{
+    pipelineWindow = 0;
+    enabledCommands = BASE_COMMANDS;
+    channelsEnabled = false;
+    universeEnabled = false;
+    acknowledgeFrames = true;
+    clockOffset = 0;
+    framingEnabled = false;
+    fragmentationEnabled = false;
+    sessionToken = 0;
+    colorLutEnabled = false;
+    if(sketchBrightness >= 0)
+    {
+        FastLED.setBrightness(sketchBrightness);
+        sketchBrightness = -1;
+    }
+}
+
+#ifdef ALUP_RENDER_PIPELINE
+/**
+ * function letting the given render pipeline present the frames instead of calling FastLED.show()
+ * Note: the pipeline has to be started using RenderPipeline::Begin(); frames are then received
+ * into its back buffer while the previous frame is shown
+ * @param pipeline: the pipeline to use; nullptr to show the frames directly
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::UseRenderPipeline(RenderPipeline* pipeline)
+{
+    renderPipeline = pipeline;
+}
+#endif
+
+/**
+ * function running the ALUP main loop
+ * Note: this function never blocks; it only consumes the bytes which are already available
+ * and keeps the state of partially received frames until the next call
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::Run()
+{
+    //do nothing if not connected
+    if(!connected)
+    {
+        return;
+    }
+    //the connection was lost, e.g. the WiFi; the next Connect() lets the master resume the session
+    if(!connection->isConnected())
+    {
+        connected = false;
+        return;
+    }
+    digitalWrite(GREEN, HIGH);
+    if(errorSignaled && (long) (millis() - errorSignalEnd) >= 0)
+    {
+        digitalWrite(RED_1, LOW);
+        digitalWrite(RED_2, LOW);
+        errorSignaled = false;
+    }
+
+    //show a frame waiting for its presentation time
+    PresentPendingFrame();
+
+    ParseAvailable();
+
+    //acknowledge all frames applied during this call at once, before the master waits for a show
+    if(connected)
+    {
+        SendPendingAcknowledgement();
+    }
+
+    //show the channels changed during this call and the previous ones at once
+    ScheduleShow();
+}
+
+/**
+ * function parsing and applying the frames of all bytes which are already received
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ParseAvailable()
+{
+    //only consume what is already received so that reading never blocks
+    int available = connection->Available();
+    while(available > 0 && connected)
+    {
+        if(parserState == ParserState::HEADER)
+        {
+            //the next frame would overwrite the leds of a frame waiting for its presentation time
+            if(!PresentPendingFrame())
+            {
+                return;
+            }
+#ifdef ALUP_RENDER_PIPELINE
+            if(renderPipeline != nullptr)
+            {
+                //receive into the back buffer once the render task took the previous frame
+                CRGB* back = renderPipeline->AcquireBack();
+                if(back == nullptr)
+                {
+                    return;
+                }
+                channels[0].leds = back;
+            }
+#endif
+            //find the sync word preceding the header
+            if(framingEnabled && syncBytes < FRAME_SYNC_SIZE)
+            {
+                available -= FindSyncWord(available);
+                continue;
+            }
+
+            //read as much of the header as possible
+            if(headerBytes == 0)
+            {
+                frameStart = Statistics::Now();
+            }
+            int count = HeaderSize() - headerBytes;
+            if(count > available)
+            {
+                count = available;
+            }
+            int read = ReadBytes(&headerBuffer[headerBytes], count);
+            if(read <= 0)
+            {
+                return;
+            }
+            headerBytes += read;
+            available -= read;
+            if(headerBytes < HeaderSize())
+            {
+                //wait for the rest of the header; a presentation time may follow it
+                continue;
+            }
+
+            //header complete; prepare reading the body
+            int headerSize = headerBytes;
+            headerBytes = 0;
+            syncBytes = 0;
+            if(framingEnabled && !CheckHeader(headerSize))
+            {
+                //the length may be corrupted too; search the next frame instead of reading the body
+                continue;
+            }
+            frame = ParseFrameHeader(headerBuffer);
+            frameResult = BeginFrame(frame);
+            if(flushPending)
+            {
+                //only discard what is already received so that reading never blocks
+                flushPending = false;
+                available -= Discard(available);
+            }
+            bodyBytesRead = 0;
+            checkBytes = 0;
+            nextSequence = frame.unused + 1;
+            parserState = ParserState::BODY;
+        }
+
+        if(parserState == ParserState::BODY)
+        {
+            available -= ReadBody(available);
+            if(bodyBytesRead < frame.body_size)
+            {
+                //wait for the rest of the body
+                return;
+            }
+            if(framingEnabled)
+            {
+                available -= ReadFrameCheck(available);
+                if(checkBytes < FRAME_CRC_SIZE)
+                {
+                    //wait for the rest of the CRC
+                    return;
+                }
+            }
+            FinishFrame();
+        }
+    }
+}
+
+/**
+ * function reading and dropping the given number of bytes from the connection
+ * @param length: the number of bytes; at most the number of bytes which can be read without blocking
+ * @return: the number of bytes read
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::Discard(int length)
+{
+    byte buffer[BODY_CHUNK_SIZE];
+    int discarded = 0;
+    while(discarded < length)
+    {
+        int count = length - discarded > BODY_CHUNK_SIZE ? BODY_CHUNK_SIZE : length - discarded;
+        int read = ReadBytes(buffer, count);
+        if(read <= 0)
+        {
+            break;
+        }
+        discarded += read;
+    }
+    return discarded;
+}
+
+/**
+ * function returning the size of the header of the current frame
+ * The header is followed by a presentation time if its command has FRAME_PRESENTATION_FLAG set
+ * and the master enabled TIME_SYNC, then by its CRC if framing is enabled.
+ * @return: the size in bytes, not including the sync word; without a presentation time as long as the command was not received
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::HeaderSize()
+{
+    int size = FRAME_HEADER_SIZE;
+    if(headerBytes >= FRAME_HEADER_SIZE && (headerBuffer[8] & FRAME_PRESENTATION_FLAG) && (enabledCommands & (1UL << Command::TIME_SYNC)))
+    {
+        size += PRESENTATION_TIME_SIZE;
+    }
+    if(framingEnabled)
+    {
+        size += FRAME_CRC_SIZE;
+    }
+    return size;
+}
+
+/**
+ * function consuming the received bytes up to the sync word preceding the next frame
+ * Note: never reads past the sync word, so the header stays in the connection
+ * @param available: the number of bytes which can be read without blocking
+ * @return: the number of bytes read
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::FindSyncWord(int available)
+{
+    const byte syncWord[FRAME_SYNC_SIZE] = {FRAME_SYNC_BYTE_1, FRAME_SYNC_BYTE_2};
+    int consumed = 0;
+    while(consumed < available && syncBytes < FRAME_SYNC_SIZE)
+    {
+        //read at most the rest of the sync word
+        byte buffer[FRAME_SYNC_SIZE];
+        int count = FRAME_SYNC_SIZE - syncBytes < available - consumed ? FRAME_SYNC_SIZE - syncBytes : available - consumed;
+        int read = ReadBytes(buffer, count);
+        if(read <= 0)
+        {
+            break;
+        }
+        for(int i = 0; i < read; i++)
+        {
+            if(buffer[i] == syncWord[syncBytes])
+            {
+                syncBytes++;
+            }
+            else
+            {
+                syncBytes = buffer[i] == syncWord[0] ? 1 : 0;
+            }
+        }
+        consumed += read;
+    }
+    return consumed;
+}
+
+/**
+ * function checking the CRC following the received header and starting the CRC of the frame
+ * A corrupted header is answered with a frame error for the expected sequence number.
+ * @param size: the size of the header including its CRC
+ * @return: true if the header is valid, else false
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+bool AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::CheckHeader(int size)
+{
+    frameCrc = Convert::Crc16(FRAME_CRC_INIT, headerBuffer, size - FRAME_CRC_SIZE);
+    if(frameCrc == ((headerBuffer[size - 2] << 8) | headerBuffer[size - 1]))
+    {
+        return true;
+    }
+    SignalError(RED_1);
+    statistics.resyncs++;
+    ALUP_TRACE(TRACE_RESYNC, 0);
+    Frame corrupted = Frame();
+    corrupted.unused = nextSequence;
+    ReportFrameError(corrupted);
+    return false;
+}
+
+/**
+ * function reading the CRC following the body of the current frame
+ * The frame is not applied if it does not match the CRC of its header and body.
+ * @param available: the number of bytes which can be read without blocking
+ * @return: the number of bytes read
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ReadFrameCheck(int available)
+{
+    int count = FRAME_CRC_SIZE - checkBytes < available ? FRAME_CRC_SIZE - checkBytes : available;
+    if(count <= 0)
+    {
+        return 0;
+    }
+    int read = ReadBytes(&frameCheck[checkBytes], count);
+    if(read <= 0)
+    {
+        return 0;
+    }
+    checkBytes += read;
+    if(checkBytes == FRAME_CRC_SIZE && frameCrc != ((frameCheck[0] << 8) | frameCheck[1]))
+    {
+        //the body is corrupted; its colors may already be in the leds, which are not shown until rewritten
+        SignalError(RED_2);
+        MarkDamaged();
+        frameResult = 0;
+    }
+    return read;
+}
+
+/**
+ * function converting the given bytes to a frame header as defined in ALUP v.0.2
+ * @param buffer: the header bytes; has to have a size of HeaderSize()
+ * @return frame: the frame header
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+Frame AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ParseFrameHeader(byte* buffer)
+{
+    Frame frame = Frame();
+    frame.body_size = Convert::BytesToInt32(&buffer[0]);
+    frame.offset = Convert::BytesToInt32(&buffer[4]);
+    frame.command = buffer[8];
+    frame.unused = buffer[9];
+    frame.timestamped = false;
+    if((frame.command & FRAME_PRESENTATION_FLAG) && (enabledCommands & (1UL << Command::TIME_SYNC)))
+    {
+        frame.command &= ~FRAME_PRESENTATION_FLAG;
+        frame.timestamped = true;
+        frame.presentationTime = Convert::BytesToInt32(&buffer[FRAME_HEADER_SIZE]);
+    }
+    return frame;
+}
+
+/**
+ * function preparing the given frame before its body is read
+ * @param frame: the frame of which the header was received
+ * @return: 1 if the body can be applied, 0 if a frame error occured
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::BeginFrame(Frame& frame)
+{
+    //by default the body is discarded
+    bodyDecoder = BodyDecoder::DECODE_DISCARD;
+    rawBodyStart = 0;
+    rawBodyBytes = 0;
+    rawColors = false;
+    frameOutsideSlice = false;
+    decodeLed = frame.offset;
+    tokenBytes = 0;
+    spanRemaining = 0;
+
+    //select the channel given by the highest byte of the offset
+    int channel = 0;
+    if(channelsEnabled)
+    {
+        channel = ((uint32_t) frame.offset) >> 24;
+        frame.offset &= 0x00FFFFFF;
+        decodeLed = frame.offset;
+    }
+    if(channel >= channelCount)
+    {
+        //invalid channel; discard the body
+        SignalError(RED_1);
+        return 0;
+    }
+    //a previous frame of the channel which was not shown yet is merged with this one, see ScheduleShow()
+    SelectChannel(channel);
+
+    if(frame.body_size < 0)
+    {
+        //the stream position is unknown; flush the received data unless the next frame is found by its sync word
+        statistics.resyncs++;
+        flushPending = !framingEnabled;
+        frame.body_size = 0;
+        return 0;
+    }
+
+    //commands which were not negotiated are invalid
+    if(frame.command >= 32 || !(enabledCommands & (1UL << frame.command)))
+    {
+        //invalid command received
+        return 0;
+    }
+
+    switch(frame.command)
+    {
+        case Command::NONE:
+            return PrepareColors(frame);
+
+        case Command::CLEAR: 
+            ClearLeds();
+            return PrepareColors(frame);
+
+        case Command::DISCONNECT: 
+        case Command::TOGGLE_INTERNAL_LED:
+            return 1;
+
+        case Command::RUN_LENGTH:
+            return PrepareEncodedColors(frame, RUN_LENGTH_TOKEN_SIZE, BodyDecoder::DECODE_RUN_LENGTH);
+
+        case Command::DELTA:
+            if((SUPPORTED_COMMANDS & (1UL << Command::COLOR_LUT)) && colorLutEnabled)
+            {
+                //the leds hold corrected colors, which the differences to the colors of the master do not apply to
+                SignalError(RED_2);
+                return 0;
+            }
+            return PrepareEncodedColors(frame, 1, BodyDecoder::DECODE_DELTA);
+
+        case Command::PALETTE_UPLOAD:
+            return PreparePalette(frame);
+
+        case Command::COLOR_LUT:
+            return PrepareColorLut(frame);
+
+        case Command::PALETTE_8:
+            return PrepareEncodedColors(frame, 1, BodyDecoder::DECODE_PALETTE_8);
+
+        case Command::PALETTE_4:
+            return PrepareEncodedColors(frame, 1, BodyDecoder::DECODE_PALETTE_4);
+
+        case Command::RGB565:
+            return PrepareEncodedColors(frame, RGB565_TOKEN_SIZE, BodyDecoder::DECODE_RGB565);
+
+        case Command::RGB444:
+            return PrepareEncodedColors(frame, RGB444_TOKEN_SIZE, BodyDecoder::DECODE_RGB444);
+
+        case Command::SCATTER:
+            return PrepareEncodedColors(frame, 1, BodyDecoder::DECODE_SCATTER);
+
+        case Command::STATISTICS:
+            if(frame.body_size != 0)
+            {
+                //invalid body size
+                return 0;
+            }
+            return 1;
+
+        case Command::TIME_SYNC:
+            if(frame.body_size != 4 && frame.body_size != TIME_SYNC_BODY_SIZE)
+            {
+                //invalid body size
+                return 0;
+            }
+            rawTarget = timeSyncBody;
+            rawBodyBytes = frame.body_size;
+            bodyDecoder = BodyDecoder::DECODE_RAW;
+            return 1;
+
+        default:
+            //invalid command received
+            return 0;
+    }
+}
+
+/**
+ * function checking if the body of the given frame can be applied to the leds
+ * @param frame: the frame of which the body will be applied
+ * @return: 1 if the body can be applied, else 0
+ */
+ template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+ int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::PrepareColors(Frame frame)
+ {
+    if(universeEnabled)
+    {
+        return PrepareSlice(frame);
+    }
+
+    //check if the frame offset is valid
+    if (frame.offset < 0 || frame.offset >= LedCount())
+    {
+        // invalid offset
+        SignalError(RED_1);
+        SignalError(RED_2);
+        return 0;
+    }
+
+    //check the frame body size if it is a multiple of 3 
+    if(frame.body_size % 3 != 0)
+    {
+        //not a multiple of 3
+        SignalError(RED_2);
+        return 0;
+    }
+
+    //check if the body size including offest excceeds the actual LEDs: (choose the smaller one)
+    int lastLED = ((frame.body_size / 3) + frame.offset) > LedCount() ? LedCount() - frame.offset : (frame.body_size / 3);
+    rawTarget = (byte*) &leds[frame.offset];
+    rawBodyBytes = lastLED * 3;
+    rawColors = true;
+    bodyDecoder = BodyDecoder::DECODE_RAW;
+    return 1;
+ }
+
+/**
+ * function checking which colors of a frame addressing the universe belong to the leds of this device
+ * The frame offset is the index of its first led in the universe, which is shared by several devices;
+ * the leds of this device start at universeStart. The colors of other devices are discarded.
+ * @param frame: the frame of which the body will be applied
+ * @return: 1 if the body can be applied, else 0
+ */
+ template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+ int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::PrepareSlice(Frame frame)
+ {
+    if(frame.offset < 0 || frame.body_size % 3 != 0)
+    {
+        //invalid offset or not a multiple of 3
+        SignalError(RED_2);
+        return 0;
+    }
+
+    //the first led of the frame relative to the leds of this device
+    int32_t first = frame.offset - universeStart;
+    int32_t count = frame.body_size / 3;
+    //the leds of the frame in front of this device
+    int32_t skipped = first < 0 ? (-first < count ? -first : count) : 0;
+    int32_t start = first + skipped;
+    int32_t applied = start < LedCount() ? count - skipped : 0;
+    if(applied > LedCount() - start)
+    {
+        applied = LedCount() - start;
+    }
+    if(applied <= 0)
+    {
+        //the frame is meant for other devices
+        frameOutsideSlice = true;
+        return 1;
+    }
+
+    rawTarget = (byte*) &leds[start];
+    rawBodyStart = skipped * 3;
+    rawBodyBytes = applied * 3;
+    rawColors = true;
+    bodyDecoder = BodyDecoder::DECODE_RAW;
+    return 1;
+ }
+
+/**
+ * function checking if the encoded body of the given frame can be decoded to the leds
+ * @param frame: the frame of which the body will be decoded
+ * @param tokenSize: the body size has to be a multiple of this size
+ * @param decoder: the decoder for the body
+ * @return: 1 if the body can be decoded, else 0
+ */
+ template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+ int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::PrepareEncodedColors(Frame frame, int tokenSize, BodyDecoder decoder)
+ {
+    if(universeEnabled && frame.offset >= 0)
+    {
+        //the offset is relative to the leds of this device
+        frame.offset -= universeStart;
+        decodeLed = frame.offset;
+        //only the device of the first led decodes the body; the segments of a scatter body may address any device
+        if(decoder != BodyDecoder::DECODE_SCATTER && (frame.offset < 0 || frame.offset >= LedCount()))
+        {
+            frameOutsideSlice = true;
+            return 1;
+        }
+    }
+    //check if the frame offset is valid
+    else if (frame.offset < 0 || frame.offset >= LedCount())
+    {
+        // invalid offset
+        SignalError(RED_1);
+        SignalError(RED_2);
+        return 0;
+    }
+
+    if(frame.body_size % tokenSize != 0)
+    {
+        //incomplete token
+        SignalError(RED_2);
+        return 0;
+    }
+
+    decodeStart = decodeLed;
+    bodyDecoder = decoder;
+    return 1;
+ }
+
+/**
+ * function checking if the body of the given frame can be stored in the palette
+ * The body contains 3 bytes per palette entry; the frame offset is the index of the first entry.
+ * @param frame: the frame of which the body will be stored
+ * @return: 1 if the body can be stored, else 0
+ */
+ template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+ int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::PreparePalette(Frame frame)
+ {
+    if(frame.offset < 0 || frame.offset >= PALETTE_SIZE || frame.body_size % 3 != 0)
+    {
+        //invalid palette index or incomplete entry
+        SignalError(RED_2);
+        return 0;
+    }
+
+    //entries exceeding the palette are discarded
+    int entries = frame.body_size / 3 > PALETTE_SIZE - frame.offset ? PALETTE_SIZE - frame.offset : frame.body_size / 3;
+    rawTarget = (byte*) &palette[frame.offset];
+    rawBodyBytes = entries * 3;
+    bodyDecoder = BodyDecoder::DECODE_RAW;
+    return 1;
+ }
+
+/**
+ * function checking if the body of the given frame can be stored in the color lookup tables
+ * The offset is the brightness (0 - 255) of the leds; offsets above 255 keep the brightness.
+ * The body is empty to keep the tables, one table of COLOR_LUT_SIZE entries for red, green and blue,
+ * or the tables of red, green and blue one after another. The tables map the colors of the
+ * following frames as they are decoded; the brightness is applied by FastLED when the leds are shown.
+ * @param frame: the frame of which the body will be stored
+ * @return: 1 if the body can be stored, else 0
+ */
+ template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+ int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::PrepareColorLut(Frame frame)
+ {
+    if(frame.offset < 0 || (frame.body_size != 0 && frame.body_size != COLOR_LUT_SIZE && frame.body_size != 3 * COLOR_LUT_SIZE))
+    {
+        //invalid brightness or incomplete tables
+        SignalError(RED_2);
+        return 0;
+    }
+    //the tables are replaced once the frame is complete and its CRC matched, see ApplyColorLut()
+    rawTarget = (byte*) stagedColorLut->tables;
+    rawBodyBytes = frame.body_size;
+    bodyDecoder = BodyDecoder::DECODE_RAW;
+    return 1;
+ }
+
+/**
+ * function reading the available part of the current frame body
+ * Note: raw colors are read straight into the led array (or palette) as CRGB uses 3 packed bytes in body order;
+ * encoded bodies are read in small chunks and decoded into the led array;
+ * body bytes exceeding the led array or belonging to an invalid frame are discarded
+ * @param available: the number of bytes which can be read without blocking
+ * @return: the number of bytes read
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ReadBody(int available)
+{
+    //encoded bodies are timed once per call instead of per chunk, see Statistics::decodeTime
+    bool encoded = bodyDecoder != BodyDecoder::DECODE_RAW && bodyDecoder != BodyDecoder::DECODE_DISCARD;
+    unsigned long start = encoded ? Statistics::Now() : 0;
+    int consumed = 0;
+    while(consumed < available && bodyBytesRead < frame.body_size)
+    {
+        int32_t count = frame.body_size - bodyBytesRead;
+        if(count > available - consumed)
+        {
+            count = available - consumed;
+        }
+
+        int read;
+        if(bodyDecoder == BodyDecoder::DECODE_RAW && bodyBytesRead >= rawBodyStart && bodyBytesRead < rawBodyStart + rawBodyBytes)
+        {
+            //read the colors into the leds according to the ALUP v. 0.2
+            if(count > rawBodyStart + rawBodyBytes - bodyBytesRead)
+            {
+                count = rawBodyStart + rawBodyBytes - bodyBytesRead;
+            }
+            read = ReadBytes(rawTarget + bodyBytesRead - rawBodyStart, count);
+            if(framingEnabled && read > 0)
+            {
+                frameCrc = Convert::Crc16(frameCrc, rawTarget + bodyBytesRead - rawBodyStart, read);
+            }
+            if(rawColors && read > 0)
+            {
+                //the colors are corrected while they are still in the cache
+                CorrectColors(rawTarget + bodyBytesRead - rawBodyStart, read, (bodyBytesRead - rawBodyStart) % 3);
+            }
+        }
+        else
+        {
+            //decode or discard the bytes
+            byte buffer[BODY_CHUNK_SIZE];
+            if(count > BODY_CHUNK_SIZE)
+            {
+                count = BODY_CHUNK_SIZE;
+            }
+            if(bodyDecoder == BodyDecoder::DECODE_RAW && bodyBytesRead < rawBodyStart && count > rawBodyStart - bodyBytesRead)
+            {
+                //discard only the colors in front of the raw colors
+                count = rawBodyStart - bodyBytesRead;
+            }
+            read = ReadBytes(buffer, count);
+            if(framingEnabled && read > 0)
+            {
+                frameCrc = Convert::Crc16(frameCrc, buffer, read);
+            }
+            if(read > 0)
+            {
+                DecodeChunk(buffer, read);
+            }
+        }
+
+        if(read <= 0)
+        {
+            break;
+        }
+        bodyBytesRead += read;
+        consumed += read;
+    }
+    if(encoded)
+    {
+        frameDecodeTime += Statistics::Now() - start;
+    }
+    return consumed;
+}
+
+/**
+ * function decoding the given part of an encoded frame body into the leds
+ * @param data: the body bytes
+ * @param length: the number of body bytes
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::DecodeChunk(byte* data, int length)
+{
+    //the decoders of commands which are not supported are left out of the program
+    switch(bodyDecoder)
+    {
+        case BodyDecoder::DECODE_RUN_LENGTH:
+            if(SUPPORTED_COMMANDS & (1UL << Command::RUN_LENGTH))
+            {
+                DecodeRunLength(data, length);
+            }
+            break;
+
+        case BodyDecoder::DECODE_DELTA:
+            if(SUPPORTED_COMMANDS & (1UL << Command::DELTA))
+            {
+                DecodeDelta(data, length);
+            }
+            break;
+
+        case BodyDecoder::DECODE_PALETTE_8:
+            if(SUPPORTED_COMMANDS & (1UL << Command::PALETTE_8))
+            {
+                DecodePalette8(data, length);
+            }
+            break;
+
+        case BodyDecoder::DECODE_PALETTE_4:
+            if(SUPPORTED_COMMANDS & (1UL << Command::PALETTE_4))
+            {
+                DecodePalette4(data, length);
+            }
+            break;
+
+        case BodyDecoder::DECODE_RGB565:
+            if(SUPPORTED_COMMANDS & (1UL << Command::RGB565))
+            {
+                DecodeRgb565(data, length);
+            }
+            break;
+
+        case BodyDecoder::DECODE_RGB444:
+            if(SUPPORTED_COMMANDS & (1UL << Command::RGB444))
+            {
+                DecodeRgb444(data, length);
+            }
+            break;
+
+        case BodyDecoder::DECODE_SCATTER:
+            if(SUPPORTED_COMMANDS & (1UL << Command::SCATTER))
+            {
+                DecodeScatter(data, length);
+            }
+            break;
+
+        default:
+            //discard the bytes
+            break;
+    }
+}
+
+/**
+ * function decoding a part of a run length encoded body
+ * The body consists of runs of RUN_LENGTH_TOKEN_SIZE bytes: count - 1, red, green, blue
+ * which are applied to consecutive leds starting at the frame offset.
+ * Note: runs may be split between two calls
+ * @param data: the body bytes
+ * @param length: the number of body bytes
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::DecodeRunLength(byte* data, int length)
+{
+    int i = 0;
+    //complete a run which was split between two chunks
+    if(tokenBytes > 0)
+    {
+        while(tokenBytes < RUN_LENGTH_TOKEN_SIZE && i < length)
+        {
+            token[tokenBytes++] = data[i++];
+        }
+        if(tokenBytes < RUN_LENGTH_TOKEN_SIZE)
+        {
+            return;
+        }
+        ApplyRun(token);
+        tokenBytes = 0;
+    }
+
+    //apply the complete runs
+    for(; i + RUN_LENGTH_TOKEN_SIZE <= length; i += RUN_LENGTH_TOKEN_SIZE)
+    {
+        ApplyRun(&data[i]);
+    }
+
+    //keep the start of a split run
+    while(i < length)
+    {
+        token[tokenBytes++] = data[i++];
+    }
+}
+
+/**
+ * function applying a single run of a run length encoded body
+ * @param run: the run; count - 1, red, green, blue
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ApplyRun(byte* run)
+{
+    int32_t count = run[0] + 1;
+    if(count > LedCount() - decodeLed)
+    {
+        count = LedCount() - decodeLed;
+    }
+    CRGB color(run[1], run[2], run[3]);
+    CorrectColors((byte*) &color, 3, 0);
+    for(int32_t i = 0; i < count; i++)
+    {
+        leds[decodeLed + i] = color;
+    }
+    decodeLed += count;
+}
+
+/**
+ * function decoding a part of a delta encoded body
+ * The body consists of spans, each starting with a header of DELTA_SPAN_HEADER_SIZE bytes:
+ * the number of unchanged leds to skip (16 bit) and the number of changed leds (16 bit),
+ * followed by 3 bytes per changed led which are XOR'd onto the current colors.
+ * The first span starts at the frame offset.
+ * Note: spans may be split between two calls
+ * @param data: the body bytes
+ * @param length: the number of body bytes
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::DecodeDelta(byte* data, int length)
+{
+    byte* ledBytes = (byte*) leds;
+    int32_t ledBytesCount = LedCount() * 3;
+    int i = 0;
+    while(i < length)
+    {
+        if(spanRemaining == 0)
+        {
+            //read the span header
+            token[tokenBytes++] = data[i++];
+            if(tokenBytes < DELTA_SPAN_HEADER_SIZE)
+            {
+                continue;
+            }
+            tokenBytes = 0;
+            decodeLed += (token[0] << 8) | token[1];
+            spanRemaining = ((token[2] << 8) | token[3]) * 3;
+            //the position of the next changed byte
+            decodePosition = decodeLed * 3;
+            decodeLed += (token[2] << 8) | token[3];
+            continue;
+        }
+
+        //XOR the changes onto the leds, ignoring those exceeding the led array
+        int32_t count = spanRemaining < length - i ? spanRemaining : length - i;
+        int32_t applied = ledBytesCount - decodePosition;
+        if(applied > count)
+        {
+            applied = count;
+        }
+        for(int32_t j = 0; j < applied; j++)
+        {
+            ledBytes[decodePosition + j] ^= data[i + j];
+        }
+        decodePosition += count;
+        spanRemaining -= count;
+        i += count;
+    }
+}
+
+/**
+ * function decoding a part of a scatter body
+ * The body consists of segments, each starting with a header of SCATTER_SEGMENT_HEADER_SIZE bytes:
+ * the index of the first led relative to the frame offset (32 bit) and the number of leds (16 bit),
+ * followed by 3 bytes per led. The segments are applied in one pass and shown once.
+ * Note: segments may be split between two calls; colors outside of the led array are ignored
+ * @param data: the body bytes
+ * @param length: the number of body bytes
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::DecodeScatter(byte* data, int length)
+{
+    byte* ledBytes = (byte*) leds;
+    int32_t ledBytesCount = LedCount() * 3;
+    int i = 0;
+    while(i < length)
+    {
+        if(spanRemaining == 0)
+        {
+            //read the segment header
+            token[tokenBytes++] = data[i++];
+            if(tokenBytes < SCATTER_SEGMENT_HEADER_SIZE)
+            {
+                continue;
+            }
+            tokenBytes = 0;
+            //decodeLed stays at the frame offset
+            int64_t first = (int64_t) decodeLed + Convert::BytesToInt32(token);
+            int32_t segmentLeds = (token[4] << 8) | token[5];
+            spanRemaining = segmentLeds * 3;
+            //the position of the next led byte; segments not reaching the leds are discarded
+            decodePosition = first >= -segmentLeds && first < LedCount() ? first * 3 : ledBytesCount;
+            continue;
+        }
+
+        //copy the colors into the leds, ignoring those outside of the led array
+        int32_t count = spanRemaining < length - i ? spanRemaining : length - i;
+        int32_t begin = decodePosition < 0 ? (-decodePosition < count ? -decodePosition : count) : 0;
+        int32_t end = ledBytesCount - decodePosition < count ? ledBytesCount - decodePosition : count;
+        if(end > begin)
+        {
+            memcpy(&ledBytes[decodePosition + begin], &data[i + begin], end - begin);
+            CorrectColors(&ledBytes[decodePosition + begin], end - begin, (decodePosition + begin) % 3);
+        }
+        decodePosition += count;
+        spanRemaining -= count;
+        i += count;
+    }
+}
+
+/**
+ * function applying the completely received frame and answering it
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::FinishFrame()
+{
+    parserState = ParserState::HEADER;
+
+    //the stages of this frame; raw colors are only read
+    statistics.readTime.Add(Statistics::Now() - frameStart);
+    if(bodyDecoder != BodyDecoder::DECODE_RAW && bodyDecoder != BodyDecoder::DECODE_DISCARD)
+    {
+        statistics.decodeTime.Add(frameDecodeTime);
+    }
+    frameDecodeTime = 0;
+
+    if(frameResult == 1)
+    {
+        //the colors of this frame may replace colors of a corrupted body
+        RepairDamaged();
+    }
+
+    //apply the frame to the leds
+    int result = frameResult == 1 ? ApplyFrame(frame) : 0;
+
+    if(result == 0)
+    {
+        //A frame error occured
+        //frame could not be applied
+        //answer with frame error
+        ReportFrameError(frame);
+    }
+    else if (result == 1 && presentationPending)
+    {
+        //the next frame is not read before this one is shown, so a master waiting for the
+        //acknowledgement does not fill the receive buffer meanwhile, see PresentPendingFrame()
+        acknowledgementDeferred = true;
+    }
+    else if (result == 1)
+    {
+        //frame applied successfully
+        //acknowledge frame
+        AcknowledgeFrame(frame);
+    } 
+}
+
+/**
+ * function decoding a part of a body of 8 bit palette indices
+ * Each byte is the palette index of one led, starting at the frame offset.
+ * @param data: the body bytes
+ * @param length: the number of body bytes
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::DecodePalette8(byte* data, int length)
+{
+    int32_t count = LedCount() - decodeLed < length ? LedCount() - decodeLed : length;
+    CRGB* target = &leds[decodeLed];
+    for(int32_t i = 0; i < count; i++)
+    {
+        target[i] = palette[data[i]];
+    }
+    CorrectColors((byte*) target, count * 3, 0);
+    decodeLed += count;
+}
+
+/**
+ * function decoding a part of a body of 4 bit palette indices
+ * Each byte contains the palette indices (0 - 15) of two leds, the first one in the high nibble,
+ * starting at the frame offset. For an odd number of leds, the last low nibble sets the led after them.
+ * @param data: the body bytes
+ * @param length: the number of body bytes
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::DecodePalette4(byte* data, int length)
+{
+    int32_t first = decodeLed;
+    for(int i = 0; i < length && decodeLed < LedCount(); i++)
+    {
+        leds[decodeLed++] = palette[data[i] >> 4];
+        if(decodeLed < LedCount())
+        {
+            leds[decodeLed++] = palette[data[i] & 0x0F];
+        }
+    }
+    CorrectColors((byte*) &leds[first], (decodeLed - first) * 3, 0);
+}
+
+/**
+ * function decoding a part of a body of 16 bit colors
+ * Each led is sent as 2 bytes (big endian): 5 bits red, 6 bits green, 5 bits blue, starting at the frame offset.
+ * The channels are expanded to 8 bits by repeating their highest bits, so 0 and the maximum
+ * map to 0 and 255; shifts are used instead of lookup tables which would be read from flash.
+ * Note: colors may be split between two calls
+ * @param data: the body bytes
+ * @param length: the number of body bytes
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::DecodeRgb565(byte* data, int length)
+{
+    //decode a color which was split between two chunks
+    int i = CompleteToken(data, length, RGB565_TOKEN_SIZE);
+    if(i < 0)
+    {
+        return;
+    }
+    if(tokenBytes == RGB565_TOKEN_SIZE)
+    {
+        tokenBytes = 0;
+        DecodeRgb565(token, RGB565_TOKEN_SIZE);
+    }
+
+    int32_t count = (length - i) / RGB565_TOKEN_SIZE;
+    if(count > LedCount() - decodeLed)
+    {
+        count = LedCount() - decodeLed;
+    }
+    CRGB* target = &leds[decodeLed];
+    const byte* source = &data[i];
+    for(int32_t j = 0; j < count; j++, source += RGB565_TOKEN_SIZE)
+    {
+        uint16_t color = (source[0] << 8) | source[1];
+        uint8_t r = color >> 11;
+        uint8_t g = (color >> 5) & 0x3F;
+        uint8_t b = color & 0x1F;
+        target[j] = CRGB((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+    }
+    CorrectColors((byte*) target, count * 3, 0);
+    decodeLed += count;
+
+    //keep the start of a split color
+    i += ((length - i) / RGB565_TOKEN_SIZE) * RGB565_TOKEN_SIZE;
+    while(i < length)
+    {
+        token[tokenBytes++] = data[i++];
+    }
+}
+
+/**
+ * function decoding a part of a body of 12 bit colors
+ * Each 3 bytes contain the colors of two leds, 4 bits per channel in the order red, green, blue,
+ * starting at the frame offset. The channels are expanded to 8 bits by repeating the nibble.
+ * For an odd number of leds, the last color sets the led after them.
+ * Note: colors may be split between two calls
+ * @param data: the body bytes
+ * @param length: the number of body bytes
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::DecodeRgb444(byte* data, int length)
+{
+    //decode a color which was split between two chunks
+    int i = CompleteToken(data, length, RGB444_TOKEN_SIZE);
+    if(i < 0)
+    {
+        return;
+    }
+    if(tokenBytes == RGB444_TOKEN_SIZE)
+    {
+        tokenBytes = 0;
+        DecodeRgb444(token, RGB444_TOKEN_SIZE);
+    }
+
+    int32_t tokens = (length - i) / RGB444_TOKEN_SIZE;
+    const byte* source = &data[i];
+    int32_t first = decodeLed;
+    for(int32_t j = 0; j < tokens && decodeLed < LedCount(); j++, source += RGB444_TOKEN_SIZE)
+    {
+        //both colors as one word: r1 g1 b1 r2 g2 b2
+        uint32_t word = ((uint32_t) source[0] << 16) | (source[1] << 8) | source[2];
+        leds[decodeLed++] = CRGB(((word >> 20) & 0x0F) * 0x11, ((word >> 16) & 0x0F) * 0x11, ((word >> 12) & 0x0F) * 0x11);
+        if(decodeLed < LedCount())
+        {
+            leds[decodeLed++] = CRGB(((word >> 8) & 0x0F) * 0x11, ((word >> 4) & 0x0F) * 0x11, (word & 0x0F) * 0x11);
+        }
+    }
+    CorrectColors((byte*) &leds[first], (decodeLed - first) * 3, 0);
+
+    //keep the start of split colors
+    i += tokens * RGB444_TOKEN_SIZE;
+    while(i < length)
+    {
+        token[tokenBytes++] = data[i++];
+    }
+}
+
+/**
+ * function completing a token of a fixed size which was split between two chunks of the body
+ * Note: the token is complete if tokenBytes equals tokenSize afterwards
+ * @param data: the body bytes
+ * @param length: the number of body bytes
+ * @param tokenSize: the size of the token
+ * @return: the index of the first byte after the token; -1 if the token is still incomplete
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::CompleteToken(byte* data, int length, int tokenSize)
+{
+    int i = 0;
+    if(tokenBytes == 0)
+    {
+        return 0;
+    }
+    while(tokenBytes < tokenSize && i < length)
+    {
+        token[tokenBytes++] = data[i++];
+    }
+    return tokenBytes < tokenSize ? -1 : i;
+}
+
+/**
+ * function setting all leds to black
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ClearLeds()
+{
+    memset((void*) leds, 0, LedCount() * sizeof(CRGB));
+}
+
+/**
+ * function applying the color lookup tables to the given decoded colors, if the master uploaded any
+ * @param bytes: the colors as red, green, blue bytes
+ * @param length: the number of bytes
+ * @param color: the color of the first byte: 0 red, 1 green, 2 blue
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::CorrectColors(byte* bytes, int32_t length, int color)
+{
+    if((SUPPORTED_COMMANDS & (1UL << Command::COLOR_LUT)) && colorLutEnabled)
+    {
+        colorLut->Apply(bytes, length, color);
+    }
+}
+
+/**
+ * function using the color lookup tables and the brightness of a received COLOR_LUT frame, see PrepareColorLut()
+ * A changed brightness shows the leds again; the colors already decoded keep the previous tables.
+ * @param frame: the frame of which the body was stored in the staged tables
+ * @return: always 1
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ApplyColorLut(Frame frame)
+{
+    if(frame.body_size == COLOR_LUT_SIZE)
+    {
+        //one table for all colors
+        memcpy(stagedColorLut->tables[1], stagedColorLut->tables[0], COLOR_LUT_SIZE);
+        memcpy(stagedColorLut->tables[2], stagedColorLut->tables[0], COLOR_LUT_SIZE);
+    }
+    if(frame.body_size != 0)
+    {
+        //swap the staged tables in; the previous tables are staged for the next upload
+        ColorLut* previous = colorLut;
+        colorLut = stagedColorLut;
+        stagedColorLut = previous;
+        //identity tables are not applied at all
+        colorLutEnabled = !colorLut->IsIdentity();
+    }
+
+    if(frame.offset > 255 || frame.offset == FastLED.getBrightness())
+    {
+        return 1;
+    }
+    if(sketchBrightness < 0)
+    {
+        //restored when the session ends
+        sketchBrightness = FastLED.getBrightness();
+    }
+    FastLED.setBrightness(frame.offset);
+    for(int i = 0; i < channelCount; i++)
+    {
+        dirtyChannels |= 1UL << i;
+    }
+    Show();
+    return 1;
+}
+
+/**
+ * function presenting the leds after a frame was applied
+ * A frame with a presentation time is shown by Run() once its time is reached, see PresentPendingFrame().
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::Show()
+{
+    if(frame.timestamped)
+    {
+        //convert the presentation time to the local clock
+        presentAt = frame.presentationTime + clockOffset;
+        presentationPending = true;
+        if((long) (presentAt - micros()) > ALUP_MAX_PRESENTATION_DELAY)
+        {
+            //the clocks are not synchronized
+            presentAt = micros();
+        }
+        PresentPendingFrame();
+        return;
+    }
+    Present();
+}
+
+/**
+ * function showing a frame which waits for its presentation time if the time is reached
+ * The frame is acknowledged once it is shown; as no header is read while a frame waits, it is still the current frame.
+ * @return: false if the frame is still waiting, else true
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+bool AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::PresentPendingFrame()
+{
+    if(!presentationPending)
+    {
+        return true;
+    }
+    unsigned long now = micros();
+    if((long) (now - presentAt) < 0)
+    {
+        return false;
+    }
+    lastSkew = now - presentAt;
+    presentationPending = false;
+    Present();
+    //a frame with a presentation time is shown on time, regardless of the max refresh rate
+    ShowChannels();
+    if(acknowledgementDeferred)
+    {
+        acknowledgementDeferred = false;
+        AcknowledgeFrame(frame);
+    }
+    return true;
+}
+
+/**
+ * function marking the leds of the applied frame to be shown
+ * Note: the channel is shown at the end of Run() together with the other channels changed
+ * since the last show, see ScheduleShow(); with a render pipeline, the frames stay in its back
+ * buffer until then
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::Present()
+{
+    dirtyChannels |= 1UL << frameChannel;
+}
+
+/**
+ * function adding a show to the statistics and to the average show time
+ * @param start: the time the show started, see Statistics::Now()
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::CountShow(unsigned long start)
+{
+    uint32_t duration = Statistics::Now() - start;
+    statistics.shows++;
+    statistics.showTime.Add(duration);
+    if(averageShowTime == 0)
+    {
+        averageShowTime = duration;
+    }
+    else
+    {
+        averageShowTime += ((int32_t) duration - (int32_t) averageShowTime) / ALUP_SHOW_TIME_WEIGHT;
+    }
+}
+
+/**
+ * function answering a TIME_SYNC frame
+ * The body contains the time of the master when it sent the frame and optionally the difference of
+ * the local clock to the master clock which the master calculated from previous answers (32 bit each).
+ * The answer is sent immediately as:
+ * TIME_SYNC_BYTE, master time of the frame, local time, skew of the last timestamped frame (32 bit each)
+ * so that the master can calculate the offset and the round trip time like NTP:
+ * offset = local time - (master time + round trip time / 2).
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::SynchronizeClock()
+{
+    if(frame.body_size == TIME_SYNC_BODY_SIZE)
+    {
+        clockOffset = Convert::BytesToInt32(&timeSyncBody[4]);
+    }
+    byte answer[13];
+    answer[0] = TIME_SYNC_BYTE;
+    memcpy(&answer[1], timeSyncBody, 4);
+    Convert::Int32ToBytes(micros(), &answer[5]);
+    Convert::Int32ToBytes(lastSkew, &answer[9]);
+    SendBytes(answer, sizeof(answer));
+}
+
+/**
+ * function answering a STATISTICS frame
+ * The answer is sent immediately as STATISTICS_BYTE followed by the statistics, see Statistics::Write()
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::SendStatistics()
+{
+    byte answer[1 + STATISTICS_SIZE];
+    answer[0] = STATISTICS_BYTE;
+    statistics.Write(&answer[1]);
+    SendBytes(answer, sizeof(answer));
+}
+
+/**
+ * function selecting the led strip the next frame is applied to
+ * @param channel: the number of the channel, see AddChannel()
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::SelectChannel(int channel)
+{
+    frameChannel = channel;
+    leds = channels[channel].leds;
+    SetLedCount(channels[channel].ledCount);
+}
+
+/**
+ * function showing the channels which were changed since they were shown last
+ * A single channel is shown using its own controller. With ALUP_PARALLEL_OUTPUT, several channels
+ * are shown by one FastLED.show() which drives all strips in parallel; else they are shown one after another.
+ * With a render pipeline, the back buffer is handed over to the render task, which shows it.
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ShowChannels()
+{
+    //damaged channels stay dirty until they are rewritten, see MarkDamaged()
+    uint32_t showing = dirtyChannels & ~damagedChannels;
+    if(showing == 0)
+    {
+        return;
+    }
+
+    unsigned long start = Statistics::Now();
+    nextShowAt = micros() + MinFrameInterval();
+#ifdef ALUP_RENDER_PIPELINE
+    if(renderPipeline != nullptr)
+    {
+        if(damagedChannels != 0)
+        {
+            //the render task shows all channels
+            return;
+        }
+        //the render task shows the leds itself
+        renderPipeline->Publish();
+        dirtyChannels = 0;
+        CountShow(start);
+        return;
+    }
+#endif
+#ifdef ALUP_PARALLEL_OUTPUT
+    bool single = (dirtyChannels & (dirtyChannels - 1)) == 0;
+    if(damagedChannels == 0 && (!single || (dirtyChannels & 1)))
+    {
+        FastLED.show();
+        dirtyChannels = 0;
+    }
+#endif
+    for(int i = 0; i < channelCount && (dirtyChannels & showing) != 0; i++)
+    {
+        if(!(dirtyChannels & showing & (1UL << i)))
+        {
+            continue;
+        }
+        if(channels[i].controller == nullptr)
+        {
+            if(damagedChannels != 0)
+            {
+                //FastLED.show() would also show the damaged channels
+                continue;
+            }
+            //shows all channels
+            FastLED.show();
+            dirtyChannels = 0;
+            break;
+        }
+        channels[i].controller->showLeds(FastLED.getBrightness());
+        dirtyChannels &= ~(1UL << i);
+    }
+    if((dirtyChannels & showing) == showing)
+    {
+        //only damaged channels had to be shown by FastLED.show()
+        return;
+    }
+    CountShow(start);
+}
+
+/**
+ * function getting the leds of the current channel written by the body of the current frame
+ * @param start: set to the index of the first written led
+ * @param end: set to the index behind the last written led
+ * @param replaced: if only leds of which the previous colors were replaced count, not those changed by a difference
+ * or by a scatter body, which are only known to be somewhere in the channel
+ * @return: true if any led was written
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+bool AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::WrittenLeds(int32_t& start, int32_t& end, bool replaced)
+{
+    start = 0;
+    end = 0;
+    if(frame.command == Command::CLEAR && replaced)
+    {
+        //all leds were cleared before the body was read
+        end = LedCount();
+        return end > 0;
+    }
+    if(frameOutsideSlice)
+    {
+        return false;
+    }
+    switch(bodyDecoder)
+    {
+        case BodyDecoder::DECODE_RAW:
+            if(rawColors)
+            {
+                start = (CRGB*) rawTarget - leds;
+                end = start + rawBodyBytes / 3;
+            }
+            break;
+
+        case BodyDecoder::DECODE_RUN_LENGTH:
+        case BodyDecoder::DECODE_PALETTE_8:
+        case BodyDecoder::DECODE_PALETTE_4:
+        case BodyDecoder::DECODE_RGB565:
+        case BodyDecoder::DECODE_RGB444:
+            start = decodeStart;
+            end = decodeLed;
+            break;
+
+        case BodyDecoder::DECODE_DELTA:
+            if(!replaced)
+            {
+                start = decodeStart;
+                end = decodeLed;
+            }
+            break;
+
+        case BodyDecoder::DECODE_SCATTER:
+            if(!replaced)
+            {
+                end = LedCount();
+            }
+            break;
+
+        default:
+            break;
+    }
+    start = start < 0 ? 0 : start;
+    end = end > LedCount() ? LedCount() : end;
+    return end > start;
+}
+
+/**
+ * function holding the shows of the current channel after the body of the current frame turned out to be corrupted
+ * The written leds are damaged until a valid frame replaces their colors, see RepairDamaged(); until then the
+ * channel is not shown, as the next valid frame may only change a part of it.
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::MarkDamaged()
+{
+    int32_t start;
+    int32_t end;
+    if(!WrittenLeds(start, end, false))
+    {
+        return;
+    }
+    uint32_t channel = 1UL << frameChannel;
+    if(damagedChannels & channel)
+    {
+        //the damaged leds are kept as one range
+        start = damagedStart[frameChannel] < start ? damagedStart[frameChannel] : start;
+        end = damagedEnd[frameChannel] > end ? damagedEnd[frameChannel] : end;
+    }
+    damagedStart[frameChannel] = start;
+    damagedEnd[frameChannel] = end;
+    damagedChannels |= channel;
+}
+
+/**
+ * function removing the leds replaced by the current valid frame from the damaged leds of its channel
+ * Note: a frame only replacing leds in the middle of the damaged range does not change it
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::RepairDamaged()
+{
+    uint32_t channel = 1UL << frameChannel;
+    int32_t start;
+    int32_t end;
+    if(!(damagedChannels & channel) || !WrittenLeds(start, end, true))
+    {
+        return;
+    }
+    if(start <= damagedStart[frameChannel] && end > damagedStart[frameChannel])
+    {
+        damagedStart[frameChannel] = end;
+    }
+    else if(start < damagedEnd[frameChannel] && end >= damagedEnd[frameChannel])
+    {
+        damagedEnd[frameChannel] = start;
+    }
+    if(damagedStart[frameChannel] >= damagedEnd[frameChannel])
+    {
+        damagedChannels &= ~channel;
+    }
+}
+
+/**
+ * function showing the changed channels if the max refresh rate allows it
+ * Frames applied before the next show is allowed are merged into it, so a burst of frames
+ * received during a slow show costs one show instead of one per frame.
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ScheduleShow()
+{
+    if(dirtyChannels != 0 && (long) (micros() - nextShowAt) >= 0)
+    {
+        ShowChannels();
+    }
+}
+
+/**
+ * function acknowledging the given frame
+ * Without pipelining, each frame is acknowledged with FRAME_ACKNOWLEDGEMENT_BYTE.
+ * With pipelining, the reserved header byte is the sequence number of the frame and
+ * FRAME_CUMULATIVE_ACKNOWLEDGEMENT_BYTE followed by the sequence number of the last applied frame
+ * acknowledges all frames up to it. It is sent at the end of Run() or every half window.
+ * Note: nothing is sent if the master disabled acknowledgements, see ConfigurationOption::UNIVERSE
+ * @param frame: the applied frame
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::AcknowledgeFrame(Frame frame)
+{
+    statistics.framesApplied++;
+    if(!acknowledgeFrames)
+    {
+        return;
+    }
+    if(pipelineWindow == 0)
+    {
+        SendByte(FRAME_ACKNOWLEDGEMENT_BYTE);
+        return;
+    }
+
+    lastSequence = frame.unused;
+    pendingAcknowledgements++;
+    //make sure the master can keep sending while this device is busy
+    if(pendingAcknowledgements * 2 >= pipelineWindow)
+    {
+        SendPendingAcknowledgement();
+    }
+}
+
+/**
+ * function answering the given frame with a frame error
+ * With pipelining, the error is followed by the sequence number of the frame
+ * and all frames applied before it are acknowledged first.
+ * Note: nothing is sent if the master disabled acknowledgements, see ConfigurationOption::UNIVERSE
+ * @param frame: the frame which could not be applied
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ReportFrameError(Frame frame)
+{
+    statistics.frameErrors++;
+    ALUP_TRACE(TRACE_FRAME_ERROR, frame.command);
+    if(!acknowledgeFrames)
+    {
+        return;
+    }
+    if(pipelineWindow == 0)
+    {
+        SendByte(FRAME_ERROR_BYTE);
+        return;
+    }
+
+    SendPendingAcknowledgement();
+    byte buffer[] = {FRAME_ERROR_BYTE, frame.unused};
+    SendBytes(buffer, 2);
+}
+
+/**
+ * function sending a cumulative acknowledgement for all applied frames which are not acknowledged yet
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::SendPendingAcknowledgement()
+{
+    if(pendingAcknowledgements == 0)
+    {
+        return;
+    }
+    byte buffer[] = {FRAME_CUMULATIVE_ACKNOWLEDGEMENT_BYTE, lastSequence};
+    SendBytes(buffer, 2);
+    pendingAcknowledgements = 0;
+}
+
+/**
+ * function applying the given frame by executing its command
+ * Note: the body of the frame has to be read completely
+ * @param frame: the frame to apply
+ * @return: 1 if applied successfully, 0 if frame error occured, -1 if no acknowledgement should be sent
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::ApplyFrame(Frame frame)
+{
+    switch(frame.command)
+    {
+        case Command::NONE:
+            if(frameOutsideSlice)
+            {
+                //nothing changed
+                return 1;
+            }
+            Show();
+            return 1;
+
+        case Command::CLEAR: 
+            Show();
+            return 1;
+
+        case Command::DISCONNECT: 
+            //acknowledge the disconnect
+            AcknowledgeFrame(frame);
+            SendPendingAcknowledgement();
+            delay(100);
+            //disconnect from the remote device
+            Disconnect();
+            return -1;
+        case Command::TOGGLE_INTERNAL_LED:
+            //test command for power LED
+            // initialize pin2 as output first!
+            digitalWrite(2, !digitalRead(2));
+            return 1;
+
+        case Command::PALETTE_UPLOAD:
+            //the palette is used by the following frames
+            return 1;
+
+        case Command::COLOR_LUT:
+            if(SUPPORTED_COMMANDS & (1UL << Command::COLOR_LUT))
+            {
+                return ApplyColorLut(frame);
+            }
+            return 0;
+
+        case Command::TIME_SYNC:
+            if(SUPPORTED_COMMANDS & (1UL << Command::TIME_SYNC))
+            {
+                SynchronizeClock();
+            }
+            return 1;
+
+        case Command::STATISTICS:
+            if(SUPPORTED_COMMANDS & (1UL << Command::STATISTICS))
+            {
+                SendStatistics();
+            }
+            return 1;
+
+        case Command::RUN_LENGTH:
+        case Command::DELTA:
+        case Command::PALETTE_8:
+        case Command::PALETTE_4:
+        case Command::RGB565:
+        case Command::RGB444:
+        case Command::SCATTER:
+            if(frameOutsideSlice)
+            {
+                //nothing changed
+                return 1;
+            }
+            //the body has to end with a complete run or span
+            if(tokenBytes != 0 || spanRemaining != 0)
+            {
+                return 0;
+            }
+            Show();
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+/**
+ * function allocating the palette used by the palette commands
+ * Note: the palette is allocated once and kept for all following connections
+ * @return: 1 if the palette is allocated, 0 if not enough memory is left
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::AllocatePalette()
+{
+    if(palette == nullptr)
+    {
+        palette = (CRGB*) calloc(PALETTE_SIZE, sizeof(CRGB));
+    }
+    return palette != nullptr;
+}
+
+/**
+ * function allocating the lookup tables used by the COLOR_LUT command and the staged tables
+ * the next upload is received into
+ * Note: the tables are allocated once and kept for all following connections
+ * @return: 1 if the tables are allocated, 0 if not enough memory is left
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+int AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::AllocateColorLut()
+{
+    if(colorLut == nullptr)
+    {
+        colorLut = (ColorLut*) malloc(2 * sizeof(ColorLut));
+        if(colorLut == nullptr)
+        {
+            return 0;
+        }
+        colorLut->Reset();
+        stagedColorLut = colorLut + 1;
+    }
+    return 1;
+}
+
+/**
+ * function turning on the given debug led for ERROR_SIGNAL_DURATION; it is turned off by Run()
+ * Note: does not block so that the following frames are not delayed
+ * @param pin: the pin of the led
+ */
+template<class ConnectionT, uint32_t SUPPORTED_COMMANDS, int LED_COUNT>
+void AlupBase<ConnectionT, SUPPORTED_COMMANDS, LED_COUNT>::SignalError(int pin)
+{
+    digitalWrite(pin, HIGH);
+    errorSignalEnd = millis() + ERROR_SIGNAL_DURATION;
+    errorSignaled = true;
+}
+
+#endif
@@ -0,0 +1,269 @@
+#include "AsyncUdpConnection.h"
+
+#if defined(ESP32)
+
+#include "Log.h"
+#include <new>
+
+
+/**
+ * default constructor
+ * @param _wifiSSID: the ssid of the wifi network to connect to
+ * @param _wifiPassword: the password of the wifi network to connect to
+ * @param _ip: the ip address of the remote device
+ * @param _port: the port of the remote device
+ */
+AsyncUdpConnection::AsyncUdpConnection(char* _wifiSSID, char* _wifiPassword, char* _ip, int _port) : ip {_ip}, port {_port}, wifiSSID {_wifiSSID}, wifiPassword {_wifiPassword}
+{
+#if ALUP_LOG_LEVEL > ALUP_LOG_LEVEL_NONE
+    if(!Serial)
+    {
+        Serial.begin(115200);
+    }
+#endif
+}
+
+/**
+ * function setting a multicast group which is joined on Connect() in addition to receiving on receivingPort
+ * see UdpConnection::JoinMulticastGroup()
+ * @param group: the multicast address, e.g. 239.1.2.3
+ */
+void AsyncUdpConnection::JoinMulticastGroup(IPAddress group)
+{
+    multicastGroup = group;
+    multicast = true;
+}
+
+/**
+ * function establishing a wifi connection and starting to receive packets in the async udp task
+ */
+void AsyncUdpConnection::Connect()
+{
+    ConnectToWifi(wifiSSID, wifiPassword);
+    remoteIp.fromString(ip);
+
+    //packets of an earlier connection are discarded
+    udp.close();
+    ClearPackets();
+    consumerTask = xTaskGetCurrentTaskHandle();
+    udp.onPacket([this](AsyncUDPPacket& packet) {
+        OnPacket(packet);
+    });
+    //unicast datagrams are received in both cases
+    if(multicast)
+    {
+        udp.listenMulticast(multicastGroup, receivingPort);
+    }
+    else
+    {
+        udp.listen(receivingPort);
+    }
+    //the connection request and the configuration are a plain byte stream
+    SetFragmentation(false);
+    connected = true;
+}
+
+/**
+ * function establishing a wifi connection using the given credentials
+ * Note: this function blocks until the connection is established successfully
+ * @param _ssid: the ssid of the wifi network to connect to
+ * @param _password: the password of the wifi network to connect to
+ */
+void AsyncUdpConnection::ConnectToWifi(char* _ssid, char* _password)
+{
+    //the WiFi may have reconnected on its own after it was lost
+    if(WiFi.status() == WL_CONNECTED)
+    {
+        return;
+    }
+    WiFi.begin(_ssid, _password);
+
+    ALUP_LOG_INFO("Connecting to wifi: ", _ssid);
+
+    while(WiFi.status() != WL_CONNECTED)
+    {
+        delay(500);
+    }
+    ALUP_LOG_INFO("Connected. IP address: ", WiFi.localIP());
+}
+
+/**
+ * function terminating the udp socket and wifi connection
+ */
+void AsyncUdpConnection::Disconnect()
+{
+    udp.close();
+    ClearPackets();
+    WiFi.disconnect();
+    connected = false;
+    ALUP_LOG_INFO("Disconnected from WiFi.");
+}
+
+/**
+ * function sending the given bytes in one datagram
+ * @param bytes: the bytes to send
+ * @param length: the length of the bytes array
+ */
+void AsyncUdpConnection::Send(uint8_t* bytes, size_t length)
+{
+    if(!isConnected())
+    {
+        ALUP_LOG_ERROR("Could not send data: Not connected!");
+        return;
+    }
+    ALUP_TRACE(TRACE_SEND, length);
+    udp.writeTo(bytes, length, remoteIp, port);
+}
+
+/**
+ * function reading the given amount of bytes into the given buffer
+ * Note: sleeps while waiting for packets instead of polling
+ * @param buffer: a buffer for the incoming bytes
+ * @param length: the number of bytes to read
+ * @return: the number of bytes filled into the buffer; less if the connection was lost
+ */
+int AsyncUdpConnection::Read(uint8_t* buffer, size_t length)
+{
+    size_t count = 0;
+    while(count < length && isConnected())
+    {
+        int available = Available();
+        if(available <= 0)
+        {
+            //woken up by OnPacket()
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ASYNC_UDP_WAIT_TIME));
+            continue;
+        }
+        if(fragmentation)
+        {
+            count += reassembler.Read(&buffer[count], length - count);
+            continue;
+        }
+        AsyncUDPPacket* packet = FrontPacket();
+        size_t read = (size_t) available < length - count ? available : length - count;
+        memcpy(&buffer[count], packet->data() + readPosition, read);
+        readPosition += read;
+        count += read;
+    }
+    ALUP_TRACE(TRACE_RECEIVE, count);
+    return count;
+}
+
+/**
+ * function returning the number of bytes which can be read without waiting
+ * Without fragmentation, these are the rest of the first packet.
+ * @return: the number of bytes available for read
+ */
+int AsyncUdpConnection::Available()
+{
+    if(fragmentation)
+    {
+        //a frame being read is completed before newer ones are received
+        if(!reassembler.Reading())
+        {
+            ReceiveFragments();
+        }
+        return reassembler.Available();
+    }
+    AsyncUDPPacket* packet = FrontPacket();
+    return packet == nullptr ? 0 : packet->length() - readPosition;
+}
+
+/**
+ * function returning if the connection is established
+ * Note: false once the WiFi is lost, so that the device reconnects
+ * @return: true if connected, else false
+ */
+bool AsyncUdpConnection::isConnected()
+{
+    return connected && WiFi.isConnected();
+}
+
+/**
+ * function returning if frames can be received in fragments, see ConfigurationOption::FRAGMENTATION
+ * @return: always true
+ */
+bool AsyncUdpConnection::SupportsFragmentation()
+{
+    return true;
+}
+
+/**
+ * function switching between receiving a plain byte stream and frames reassembled from fragments
+ * Note: frames of an earlier connection are discarded
+ * @param enabled: true to receive reassembled frames
+ */
+void AsyncUdpConnection::SetFragmentation(bool enabled)
+{
+    fragmentation = enabled;
+    reassembler.Reset();
+}
+
+/**
+ * function queueing a received packet; called by the async udp task
+ * Note: the copy of the packet only references its buffer, so the payload is not copied
+ * @param packet: the received packet
+ */
+void AsyncUdpConnection::OnPacket(AsyncUDPPacket& packet)
+{
+    AsyncUDPPacket* queued = new (std::nothrow) AsyncUDPPacket(packet);
+    if(queued == nullptr || !packets.Push(queued))
+    {
+        //loop() falls behind; the packet is dropped like by a full socket buffer
+        delete queued;
+        droppedPackets++;
+        return;
+    }
+    xTaskNotifyGive(consumerTask);
+}
+
+/**
+ * function returning the first packet which was not read completely; read packets are released
+ * @return: the packet; nullptr if none was received
+ */
+AsyncUDPPacket* AsyncUdpConnection::FrontPacket()
+{
+    AsyncUDPPacket** front = packets.Front();
+    while(front != nullptr && readPosition >= (*front)->length())
+    {
+        delete *front;
+        packets.Discard();
+        readPosition = 0;
+        front = packets.Front();
+    }
+    return front == nullptr ? nullptr : *front;
+}
+
+/**
+ * function adding all packets received so far to the reassembler, so that only the newest complete frame is read
+ */
+void AsyncUdpConnection::ReceiveFragments()
+{
+    AsyncUDPPacket* packet;
+    while(packets.Pop(packet))
+    {
+        //the rest of a plain packet read before fragmentation was enabled is discarded
+        if(readPosition == 0)
+        {
+            reassembler.Add(packet->data(), packet->length());
+        }
+        readPosition = 0;
+        delete packet;
+    }
+}
+
+/**
+ * function releasing all queued packets
+ * Note: only called while the async udp task does not push packets
+ */
+void AsyncUdpConnection::ClearPackets()
+{
+    AsyncUDPPacket* packet;
+    while(packets.Pop(packet))
+    {
+        delete packet;
+    }
+    readPosition = 0;
+}
+
+#endif
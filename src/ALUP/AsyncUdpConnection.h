@@ -0,0 +1,80 @@
+#ifndef ASYNC_UDP_CONNECTION_H
+#define ASYNC_UDP_CONNECTION_H
+
+//the async udp stack is only part of the ESP32 core
+#if defined(ESP32)
+
+#include "Connection.h"
+#include "FrameReassembler.h"
+#include "SpscQueue.h"
+#include <AsyncUDP.h>
+#include <WiFi.h>
+
+//the number of received packets which can wait for loop(); further packets are dropped
+#ifndef ALUP_ASYNC_UDP_QUEUE_SIZE
+#define ALUP_ASYNC_UDP_QUEUE_SIZE 16
+#endif
+//the time Read() sleeps at most while waiting for a packet before checking the connection again in ms
+#define ASYNC_UDP_WAIT_TIME 100
+
+/**
+ * class implementing a udp connection which receives in the callback of the async udp stack
+ * The callback keeps each packet referenced and pushes it into a lock-free queue without copying its
+ * payload; Alup reads it from loop(). Instead of polling, Read() sleeps until the callback notifies it.
+ * Note: a drop-in replacement for UdpConnection on the ESP32
+ */
+class AsyncUdpConnection final : public Connection
+{
+    public:
+        //ip and port of the remote socket
+        char* ip;
+        int port;
+        //the port of this device's udp socket where data is received
+        int receivingPort = 5012;
+        bool connected = false;
+        //the multicast group which is joined to receive frames sent to several devices, see JoinMulticastGroup()
+        IPAddress multicastGroup;
+        bool multicast = false;
+
+        //reassembles the frames received in fragments, see ConfigurationOption::FRAGMENTATION
+        FrameReassembler reassembler;
+        //if datagrams carry fragments instead of a plain byte stream
+        bool fragmentation = false;
+        //the packets dropped because the queue was full
+        volatile uint32_t droppedPackets = 0;
+
+        AsyncUdpConnection(char* _wifiSSID, char* _wifiPassword, char* _ip, int _port);
+        void JoinMulticastGroup(IPAddress group);
+        void Connect();
+        void Disconnect();
+        void Send(uint8_t* bytes, size_t size);
+        int Read(uint8_t* buffer, size_t length);
+        int Available();
+        bool isConnected();
+        bool SupportsFragmentation();
+        void SetFragmentation(bool enabled);
+
+    private:
+        //the credentials for the wifi-network
+        char* wifiSSID;
+        char* wifiPassword;
+        //the async udp socket and the address of the remote socket
+        AsyncUDP udp;
+        IPAddress remoteIp;
+        //the received packets; pushed by the async udp task, popped by loop()
+        SpscQueue<AsyncUDPPacket*, ALUP_ASYNC_UDP_QUEUE_SIZE> packets;
+        //the number of bytes read of the first packet
+        size_t readPosition = 0;
+        //the task calling Connect(), which is notified of received packets
+        TaskHandle_t consumerTask = nullptr;
+
+        void ConnectToWifi(char* _ssid, char* _password);
+        void OnPacket(AsyncUDPPacket& packet);
+        AsyncUDPPacket* FrontPacket();
+        void ReceiveFragments();
+        void ClearPackets();
+};
+
+#endif
+
+#endif
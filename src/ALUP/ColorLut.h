@@ -0,0 +1,80 @@
+#ifndef COLOR_LUT_H
+#define COLOR_LUT_H
+
+#include <stdint.h>
+
+//the number of entries of each lookup table: one per 8 bit value
+#define COLOR_LUT_SIZE 256
+
+/**
+ * class holding lookup tables for the red, green and blue values of colors, e.g. for gamma or color
+ * correction, which are applied to led colors as they are decoded
+ */
+class ColorLut
+{
+    public:
+        //the tables of red, green and blue
+        uint8_t tables[3][COLOR_LUT_SIZE];
+
+        /**
+         * function setting all tables to the identity, which does not change any color
+         */
+        void Reset()
+        {
+            for(int i = 0; i < COLOR_LUT_SIZE; i++)
+            {
+                tables[0][i] = i;
+                tables[1][i] = i;
+                tables[2][i] = i;
+            }
+        }
+
+        /**
+         * function checking if the tables do not change any color, so that applying them can be skipped
+         * @return: true if all tables are the identity
+         */
+        bool IsIdentity()
+        {
+            for(int i = 0; i < COLOR_LUT_SIZE; i++)
+            {
+                if(tables[0][i] != i || tables[1][i] != i || tables[2][i] != i)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * function replacing the given bytes of led colors by their table entries
+         * @param bytes: the colors as red, green, blue bytes
+         * @param length: the number of bytes
+         * @param color: the color of the first byte: 0 red, 1 green, 2 blue
+         */
+        void Apply(uint8_t* bytes, int32_t length, int color = 0)
+        {
+            int32_t i = 0;
+            //complete a led of which the first colors were applied before
+            for(; i < length && color != 0; i++)
+            {
+                bytes[i] = tables[color][bytes[i]];
+                color = color == 2 ? 0 : color + 1;
+            }
+            const uint8_t* red = tables[0];
+            const uint8_t* green = tables[1];
+            const uint8_t* blue = tables[2];
+            for(; i + 3 <= length; i += 3)
+            {
+                bytes[i] = red[bytes[i]];
+                bytes[i + 1] = green[bytes[i + 1]];
+                bytes[i + 2] = blue[bytes[i + 2]];
+            }
+            for(; i < length; i++)
+            {
+                bytes[i] = tables[color][bytes[i]];
+                color++;
+            }
+        }
+};
+
+#endif
@@ -37,6 +37,50 @@ class Connection
          * @return: true if connected, else false
          */
         virtual bool isConnected() = 0;
+        /**
+         * function returning the baud rate the connection currently uses
+         * @return: the baud rate; 0 if the connection has no baud rate
+         */
+        virtual long GetBaudRate()
+        {
+            return 0;
+        }
+        /**
+         * function writing the baud rates the connection can switch to, see ConfigurationOption::BAUD_RATE
+         * @param rates: a buffer of the given size to store the rates
+         * @param maxCount: the size of the buffer
+         * @return: the number of rates written; 0 if the baud rate can not be changed
+         */
+        virtual int GetBaudRates(long* rates, int maxCount)
+        {
+            return 0;
+        }
+        /**
+         * function switching to the given baud rate after the bytes already sent were transmitted
+         * @param baud: the new baud rate
+         * @return: true if the rate was changed, else false
+         */
+        virtual bool SetBaudRate(long baud)
+        {
+            return false;
+        }
+        /**
+         * function returning if the connection can receive frames split into datagrams with a fragment
+         * header, see ConfigurationOption::FRAGMENTATION
+         */
+        virtual bool SupportsFragmentation()
+        {
+            return false;
+        }
+        /**
+         * function switching between receiving a plain byte stream and frames reassembled from fragments
+         * Note: Connect() starts with a plain byte stream, which is used for the connection request and the configuration
+         * @param enabled: true to receive reassembled frames
+         */
+        virtual void SetFragmentation(bool enabled)
+        {
+
+        }
 };
 
 
@@ -51,7 +51,23 @@ class Convert
             return number;
         }
 
-
+        /**
+         * function continuing the CRC-16/CCITT (polynomial 0x1021) of the given bytes
+         * @param crc: the CRC of the previous bytes; FRAME_CRC_INIT for the first bytes
+         * @param bytes: the bytes to add
+         * @param length: the number of bytes
+         * @return: the CRC including the given bytes
+         */
+        static uint16_t Crc16(uint16_t crc, const byte* bytes, int length)
+        {
+            for(int i = 0; i < length; i++)
+            {
+                uint8_t x = (crc >> 8) ^ bytes[i];
+                x ^= x >> 4;
+                crc = (crc << 8) ^ ((uint16_t) x << 12) ^ ((uint16_t) x << 5) ^ x;
+            }
+            return crc;
+        }
 };
 
 #endif
\ No newline at end of file
@@ -2,14 +2,29 @@
 #define FRAME_H
 
 #include <Arduino.h>
+
+//the size of a frame header in bytes
+#define FRAME_HEADER_SIZE 10
+//flag of the command byte: the header is followed by the presentation time of the frame
+#define FRAME_PRESENTATION_FLAG 0x80
+//the size of the presentation time following a flagged header
+#define PRESENTATION_TIME_SIZE 4
+//the sync word preceding each frame if framing is negotiated
+#define FRAME_SYNC_BYTE_1 0xA5
+#define FRAME_SYNC_BYTE_2 0x5A
+#define FRAME_SYNC_SIZE 2
+//the size of the CRCs following the header and the body if framing is negotiated
+#define FRAME_CRC_SIZE 2
+//the initial value of the frame CRCs, see Convert::Crc16()
+#define FRAME_CRC_INIT 0xFFFF
+
 /**
- * class representing a frame as defined in the ALUP v.0.2
+ * class representing the header of a frame as defined in the ALUP v.0.2
+ * Note: the body is not stored; it is read from the connection while the frame is applied
  */
 class Frame
 {
     public:
-      //array containing the data of this frame
-      byte* body;
       //the size of the data
       int32_t body_size;
       //the offset of the first body value
@@ -17,7 +32,12 @@ class Frame
       //the command byte
       uint8_t command;
       //leftover byte, reserved for future use
+      //carries the sequence number of the frame if pipelining is negotiated
       uint8_t unused;
+      //if the frame has a presentation time, see FRAME_PRESENTATION_FLAG
+      bool timestamped;
+      //the time at which the frame is shown in microseconds of the master clock
+      uint32_t presentationTime;
         
 };
 enum Command
@@ -25,7 +45,29 @@ enum Command
   NONE = 0,
   CLEAR = 1,
   DISCONNECT = 2,
-  TOGGLE_INTERNAL_LED = 4
+  TOGGLE_INTERNAL_LED = 4,
+  //run length encoded colors, see Alup::DecodeRunLength()
+  RUN_LENGTH = 8,
+  //colors XOR'd onto the current ones in changed spans, see Alup::DecodeDelta()
+  DELTA = 9,
+  //colors stored in the palette, starting at the palette index given by the offset
+  PALETTE_UPLOAD = 10,
+  //8 bit palette indices, see Alup::DecodePalette8()
+  PALETTE_8 = 11,
+  //4 bit palette indices, see Alup::DecodePalette4()
+  PALETTE_4 = 12,
+  //16 bit colors, see Alup::DecodeRgb565()
+  RGB565 = 13,
+  //12 bit colors, see Alup::DecodeRgb444()
+  RGB444 = 14,
+  //colors of multiple separate ranges of leds, see Alup::DecodeScatter()
+  SCATTER = 15,
+  //clock synchronization with the master, see Alup::SynchronizeClock()
+  TIME_SYNC = 16,
+  //the counters and stage timings of the device, see Alup::SendStatistics()
+  STATISTICS = 17,
+  //lookup tables applied to the colors of the following frames and the brightness, see Alup::PrepareColorLut()
+  COLOR_LUT = 18
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,213 @@
+#ifndef FRAME_REASSEMBLER_H
+#define FRAME_REASSEMBLER_H
+
+#include <Arduino.h>
+
+//the size of the header of each datagram once fragmentation was negotiated:
+//frame id (16 bit), fragment index (1 byte), fragment count (1 byte), frame size (16 bit)
+#define FRAGMENT_HEADER_SIZE 6
+
+//the size of the largest frame which can be reassembled; two buffers of this size are used
+#ifndef ALUP_MAX_FRAGMENTED_FRAME_SIZE
+#define ALUP_MAX_FRAGMENTED_FRAME_SIZE 4096
+#endif
+
+/**
+ * class reassembling frames sent in several datagrams, see ConfigurationOption::FRAGMENTATION
+ * A frame is any part of the byte stream, usually one or more complete ALUP frames. It is split into
+ * fragments of ceil(frame size / fragment count) bytes (the last one may be shorter), each sent in a datagram
+ * preceded by the fragment header. Fragments may arrive in any order. Frame ids count up (modulo 2^16);
+ * once a fragment of a newer frame arrives, an incomplete frame is dropped and fragments of older frames
+ * are discarded. A complete frame replaces the frame waiting to be read unless reading it already began,
+ * so only the newest complete frame is read.
+ */
+class FrameReassembler
+{
+    public:
+        //the frames dropped because a newer frame arrived before they were complete or read
+        uint32_t droppedFrames = 0;
+        //the fragments discarded because they were invalid, duplicated or belonged to an older frame
+        uint32_t discardedFragments = 0;
+
+        /**
+         * function checking the header of a fragment and returning where its payload belongs
+         * Note: call EndFragment() once the payload was written; do not call it while Reading()
+         * @param header: the fragment header of FRAGMENT_HEADER_SIZE bytes
+         * @param length: the length of the payload following the header
+         * @return: the buffer to write the payload to; nullptr if the fragment has to be discarded
+         */
+        byte* BeginFragment(const byte* header, int length)
+        {
+            uint16_t id = (header[0] << 8) | header[1];
+            int index = header[2];
+            int count = header[3];
+            int size = (header[4] << 8) | header[5];
+            if(count == 0 || index >= count || size == 0 || size > ALUP_MAX_FRAGMENTED_FRAME_SIZE)
+            {
+                discardedFragments++;
+                return nullptr;
+            }
+            int fragmentSize = (size + count - 1) / count;
+            int offset = index * fragmentSize;
+            if(offset >= size || length != (size - offset < fragmentSize ? size - offset : fragmentSize))
+            {
+                discardedFragments++;
+                return nullptr;
+            }
+
+            if(assembling && id == frameId)
+            {
+                if(size != frameSize || count != fragmentCount || (received[index / 32] & (1UL << (index % 32))))
+                {
+                    //the fragment does not match the frame or was received before
+                    discardedFragments++;
+                    return nullptr;
+                }
+            }
+            else if(!idKnown || (int16_t) (id - frameId) > 0)
+            {
+                //a newer frame; the one being assembled is out of date
+                if(assembling)
+                {
+                    droppedFrames++;
+                }
+                assembling = true;
+                idKnown = true;
+                frameId = id;
+                frameSize = size;
+                fragmentCount = count;
+                receivedCount = 0;
+                memset(received, 0, sizeof(received));
+            }
+            else
+            {
+                //a fragment of an older or already complete frame
+                discardedFragments++;
+                return nullptr;
+            }
+            pendingFragment = index;
+            return &buffers[assemblyBuffer][offset];
+        }
+
+        /**
+         * function marking the fragment started by BeginFragment() as received
+         * The frame is ready to be read once all its fragments were received.
+         */
+        void EndFragment()
+        {
+            if(pendingFragment < 0)
+            {
+                return;
+            }
+            received[pendingFragment / 32] |= 1UL << (pendingFragment % 32);
+            pendingFragment = -1;
+            receivedCount++;
+            if(receivedCount < fragmentCount)
+            {
+                return;
+            }
+
+            //the frame is complete
+            assembling = false;
+            if(Reading())
+            {
+                //the frame being read is never replaced
+                droppedFrames++;
+                return;
+            }
+            if(Available() > 0)
+            {
+                //the frame waiting to be read is out of date
+                droppedFrames++;
+            }
+            assemblyBuffer = 1 - assemblyBuffer;
+            readySize = frameSize;
+            readPosition = 0;
+        }
+
+        /**
+         * function adding the given datagram
+         * @param datagram: the fragment header followed by the payload
+         * @param length: the length of the datagram
+         */
+        void Add(const byte* datagram, int length)
+        {
+            if(length < FRAGMENT_HEADER_SIZE)
+            {
+                discardedFragments++;
+                return;
+            }
+            byte* payload = BeginFragment(datagram, length - FRAGMENT_HEADER_SIZE);
+            if(payload != nullptr)
+            {
+                memcpy(payload, &datagram[FRAGMENT_HEADER_SIZE], length - FRAGMENT_HEADER_SIZE);
+                EndFragment();
+            }
+        }
+
+        /**
+         * function returning if reading the complete frame began but did not finish yet
+         */
+        bool Reading()
+        {
+            return readPosition > 0 && readPosition < readySize;
+        }
+
+        /**
+         * function returning the number of bytes of the complete frame which were not read yet
+         */
+        int Available()
+        {
+            return readySize - readPosition;
+        }
+
+        /**
+         * function reading bytes of the complete frame
+         * @param buffer: a buffer of the given length
+         * @param length: the maximum number of bytes to read
+         * @return: the number of bytes read; less than length if the rest of the frame is shorter
+         */
+        int Read(byte* buffer, int length)
+        {
+            int count = Available() < length ? Available() : length;
+            memcpy(buffer, &buffers[1 - assemblyBuffer][readPosition], count);
+            readPosition += count;
+            return count;
+        }
+
+        /**
+         * function discarding all frames, e.g. when the master connects again and starts new frame ids
+         */
+        void Reset()
+        {
+            assembling = false;
+            idKnown = false;
+            pendingFragment = -1;
+            readySize = 0;
+            readPosition = 0;
+        }
+
+    private:
+        //the frame being assembled and the complete frame being read
+        byte buffers[2][ALUP_MAX_FRAGMENTED_FRAME_SIZE];
+        int assemblyBuffer = 0;
+
+        //if a frame is being assembled
+        bool assembling = false;
+        //if frameId is the id of the newest frame received since the last Reset()
+        bool idKnown = false;
+        uint16_t frameId = 0;
+        int frameSize = 0;
+        int fragmentCount = 0;
+        //the fragments received of the frame being assembled; bit n is fragment n
+        uint32_t received[8];
+        int receivedCount = 0;
+        //the fragment between BeginFragment() and EndFragment(); -1 if none
+        int pendingFragment = -1;
+
+        //the size of the complete frame and the number of its bytes read
+        int readySize = 0;
+        int readPosition = 0;
+};
+
+#endif
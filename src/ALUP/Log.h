@@ -0,0 +1,143 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+//the log levels; messages of a level above ALUP_LOG_LEVEL compile to nothing
+#define ALUP_LOG_LEVEL_NONE 0
+#define ALUP_LOG_LEVEL_ERROR 1
+#define ALUP_LOG_LEVEL_INFO 2
+#define ALUP_LOG_LEVEL_DEBUG 3
+
+#ifndef ALUP_LOG_LEVEL
+#define ALUP_LOG_LEVEL ALUP_LOG_LEVEL_INFO
+#endif
+
+//the stream the messages are printed to
+//Note: do not log to Serial while the master is connected using a SerialConnection
+#ifndef ALUP_LOG_OUTPUT
+#define ALUP_LOG_OUTPUT Serial
+#endif
+
+//the number of events kept by the trace; define it to record events using ALUP_TRACE()
+//#define ALUP_TRACE_SIZE 64
+
+//the events recorded by the trace
+#define TRACE_SEND 1
+#define TRACE_RECEIVE 2
+#define TRACE_FRAME_ERROR 3
+#define TRACE_RESYNC 4
+
+/**
+ * class printing log messages and recording the trace
+ * Note: use the macros below so that disabled messages do not cost anything
+ */
+class Log
+{
+    public:
+        /**
+         * function printing the given values followed by a line break
+         */
+        template<typename... Values>
+        static void Print(Values... values)
+        {
+            PrintValues(values...);
+            ALUP_LOG_OUTPUT.println();
+        }
+
+#ifdef ALUP_TRACE_SIZE
+        /**
+         * function recording an event in the trace without formatting it
+         * Note: the oldest event is overwritten once ALUP_TRACE_SIZE events were recorded
+         * @param event: the event, e.g. TRACE_SEND
+         * @param value: a value of the event, e.g. the number of bytes sent
+         */
+        static void Trace(uint8_t event, uint32_t value)
+        {
+            TraceBuffer& trace = GetTrace();
+            trace.events[trace.next] = {(uint32_t) micros(), value, event};
+            trace.next = (trace.next + 1) % ALUP_TRACE_SIZE;
+            if(trace.count < ALUP_TRACE_SIZE)
+            {
+                trace.count++;
+            }
+        }
+
+        /**
+         * function printing the recorded events, oldest first, and clearing the trace
+         * Each event is printed as: time in microseconds, event, value
+         * Note: call it when the timing does not matter, e.g. after the master disconnected
+         */
+        static void PrintTrace()
+        {
+            TraceBuffer& trace = GetTrace();
+            int first = (trace.next + ALUP_TRACE_SIZE - trace.count) % ALUP_TRACE_SIZE;
+            for(int i = 0; i < trace.count; i++)
+            {
+                TraceEvent& event = trace.events[(first + i) % ALUP_TRACE_SIZE];
+                Print(event.time, " ", event.event, " ", event.value);
+            }
+            trace.count = 0;
+        }
+#endif
+
+    private:
+        static void PrintValues()
+        {
+        }
+
+        template<typename Value, typename... Values>
+        static void PrintValues(Value value, Values... values)
+        {
+            ALUP_LOG_OUTPUT.print(value);
+            PrintValues(values...);
+        }
+
+#ifdef ALUP_TRACE_SIZE
+        struct TraceEvent
+        {
+            uint32_t time;
+            uint32_t value;
+            uint8_t event;
+        };
+
+        struct TraceBuffer
+        {
+            TraceEvent events[ALUP_TRACE_SIZE];
+            int next = 0;
+            int count = 0;
+        };
+
+        static TraceBuffer& GetTrace()
+        {
+            static TraceBuffer trace;
+            return trace;
+        }
+#endif
+};
+
+#if ALUP_LOG_LEVEL >= ALUP_LOG_LEVEL_ERROR
+#define ALUP_LOG_ERROR(...) Log::Print(__VA_ARGS__)
+#else
+#define ALUP_LOG_ERROR(...) do {} while(0)
+#endif
+
+#if ALUP_LOG_LEVEL >= ALUP_LOG_LEVEL_INFO
+#define ALUP_LOG_INFO(...) Log::Print(__VA_ARGS__)
+#else
+#define ALUP_LOG_INFO(...) do {} while(0)
+#endif
+
+#if ALUP_LOG_LEVEL >= ALUP_LOG_LEVEL_DEBUG
+#define ALUP_LOG_DEBUG(...) Log::Print(__VA_ARGS__)
+#else
+#define ALUP_LOG_DEBUG(...) do {} while(0)
+#endif
+
+#ifdef ALUP_TRACE_SIZE
+#define ALUP_TRACE(event, value) Log::Trace(event, value)
+#else
+#define ALUP_TRACE(event, value) do {} while(0)
+#endif
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef RENDER_PIPELINE_H
+#define RENDER_PIPELINE_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+//the render pipeline needs a second core (ESP32) or threads (host build)
+#if defined(ESP32) || defined(ALUP_HOST)
+#define ALUP_RENDER_PIPELINE
+
+#include <atomic>
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <thread>
+#endif
+
+//the core running the render task on the ESP32; the Arduino loop() runs on core 1
+#define RENDER_TASK_CORE 0
+#define RENDER_TASK_STACK_SIZE 4096
+#define RENDER_TASK_PRIORITY 1
+
+/**
+ * class presenting frames on a separate core while the next frame is received
+ * Frames are received into the back buffer and handed over to the render task with a lock-free
+ * buffer swap. The render task points the led controller to the new front buffer and shows it,
+ * while the receiver continues with the other buffer.
+ * Note: the receiver has to wait with the next frame until the render task took the previous one,
+ * so frames are never dropped
+ */
+class RenderPipeline
+{
+    public:
+        /**
+         * default constructor
+         * @param _controller: the led controller returned by FastLED.addLeds()
+         * @param front: the led array registered with the controller
+         * @param back: a second led array of the same size
+         * @param _ledCount: the size of both led arrays
+         */
+        RenderPipeline(CLEDController* _controller, CRGB* front, CRGB* back, int _ledCount) : controller {_controller}, ledCount {_ledCount}
+        {
+            buffers[0] = front;
+            buffers[1] = back;
+        }
+
+        /**
+         * function starting the render task
+         */
+        void Begin()
+        {
+            state.store(0);
+            backAcquired = false;
+            controller->setLeds(buffers[0], ledCount);
+            running.store(true);
+#if defined(ESP32)
+            xTaskCreatePinnedToCore(RenderTask, "ALUP render", RENDER_TASK_STACK_SIZE, this, RENDER_TASK_PRIORITY, &renderTask, RENDER_TASK_CORE);
+#else
+            renderThread = std::thread(&RenderPipeline::RenderLoop, this);
+#endif
+        }
+
+        /**
+         * function stopping the render task
+         * Note: a frame which was published but not shown yet is dropped
+         */
+        void End()
+        {
+            running.store(false);
+#if defined(ESP32)
+            xTaskNotifyGive(renderTask);
+#else
+            if(renderThread.joinable())
+            {
+                renderThread.join();
+            }
+#endif
+        }
+
+        /**
+         * function returning the buffer the next frame is received into
+         * Note: called by the receiver; the buffer contains the last published frame so that
+         * frames updating only parts of the leds can be applied to it
+         * @return: the back buffer; nullptr if the previous frame was not taken by the render task yet
+         */
+        CRGB* AcquireBack()
+        {
+            if(backAcquired)
+            {
+                return buffers[1 - frontIndex];
+            }
+
+            uint8_t current = state.load(std::memory_order_acquire);
+            if(current & PENDING)
+            {
+                return nullptr;
+            }
+            frontIndex = current & FRONT;
+            //start from the last frame
+            memcpy((void*) buffers[1 - frontIndex], buffers[frontIndex], ledCount * sizeof(CRGB));
+            backAcquired = true;
+            return buffers[1 - frontIndex];
+        }
+
+        /**
+         * function handing the back buffer over to the render task
+         * Note: called by the receiver after a frame was completely received into the back buffer
+         */
+        void Publish()
+        {
+            backAcquired = false;
+            state.store(frontIndex | PENDING, std::memory_order_release);
+#if defined(ESP32)
+            xTaskNotifyGive(renderTask);
+#endif
+        }
+
+        /**
+         * function returning if the render task took the last published frame
+         */
+        bool Idle()
+        {
+            return !(state.load(std::memory_order_acquire) & PENDING);
+        }
+
+    private:
+        //the bits of state
+        static const uint8_t FRONT = 1;
+        static const uint8_t PENDING = 2;
+
+        CLEDController* controller;
+        CRGB* buffers[2];
+        int ledCount;
+        //the index of the front buffer and if a frame is waiting for the render task
+        std::atomic<uint8_t> state {0};
+        std::atomic<bool> running {false};
+        //receiver side: the front buffer when the back buffer was acquired
+        uint8_t frontIndex = 0;
+        bool backAcquired = false;
+
+#if defined(ESP32)
+        TaskHandle_t renderTask = nullptr;
+
+        static void RenderTask(void* pipeline)
+        {
+            ((RenderPipeline*) pipeline)->RenderLoop();
+            vTaskDelete(nullptr);
+        }
+#else
+        std::thread renderThread;
+#endif
+
+        /**
+         * function showing each published frame until the pipeline is stopped
+         */
+        void RenderLoop()
+        {
+            while(running.load())
+            {
+                uint8_t current = state.load(std::memory_order_acquire);
+                if(!(current & PENDING))
+                {
+                    //wait for the next frame
+#if defined(ESP32)
+                    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#else
+                    std::this_thread::yield();
+#endif
+                    continue;
+                }
+
+                //swap the buffers; the receiver may use the old front buffer from now on
+                uint8_t front = 1 - (current & FRONT);
+                controller->setLeds(buffers[front], ledCount);
+                state.store(front, std::memory_order_release);
+
+                FastLED.show();
+            }
+        }
+};
+
+#endif
+
+#endif
@@ -5,12 +5,28 @@
 #include "Arduino.h"
 
 #define SERIAL_TIMEOUT_MS 10000
+//the size of the serial receive buffer on boards which allow to change it
+//a bigger buffer lets Read() take more bytes per call and prevents overruns at high baud rates
+#define SERIAL_CONNECTION_RX_BUFFER_SIZE 1024
+
+//the baud rates a master can switch to during the configuration exchange, see ConfigurationOption::BAUD_RATE
+//a rate the USB serial adapter of the master can not transfer fails the verification and is not used
+#ifndef SERIAL_CONNECTION_BAUD_RATES
+#if defined(ESP32) || defined(ESP8266) || defined(ALUP_HOST)
+#define SERIAL_CONNECTION_BAUD_RATES {115200, 230400, 460800, 921600, 1000000, 2000000, 4000000}
+#elif defined(__AVR__) && F_CPU == 16000000L
+//the rates a 16 MHz AVR UART transfers without error in double speed mode
+#define SERIAL_CONNECTION_BAUD_RATES {115200, 250000, 500000, 1000000}
+#else
+#define SERIAL_CONNECTION_BAUD_RATES {115200}
+#endif
+#endif
 
 /**
  * class implementing serial connectivity for this library
  */
 
-class SerialConnection : public Connection
+class SerialConnection final : public Connection
 {
 public:
     /**
@@ -22,6 +38,7 @@ public:
       
     }
 
+    //the baud rate used when connecting
     long baud = 115200;
 
     /**
@@ -32,7 +49,7 @@ public:
         //set the serial timeout to 10s
         //this value may need adjustment
         Serial.setTimeout(SERIAL_TIMEOUT_MS);
-        Serial.begin(baud);    
+        Begin(baud);
         delay(100);   
     }
     /**
@@ -60,18 +77,24 @@ public:
      */
     int Read(uint8_t* buffer, size_t length) 
     {
-        // use a temporary buffer as the builtin serial buffer is 64B max
-        // which is to small for some applications 
-        uint8_t temp[1];
-        for(size_t i = 0; i < length; i ++)
+        // the builtin serial buffer may be smaller than the requested length,
+        // so read whatever is buffered in one call until the request is satisfied
+        size_t count = 0;
+        while(count < length)
         {
-            while(Available() < 1)
+            int available = Serial.available();
+            if(available <= 0)
             {
                 //wait for data
-            } 
-            //read the next byte from the serial connection
-            Serial.readBytes(temp, 1);
-            buffer[i] = temp[0];
+                continue;
+            }
+            size_t chunk = length - count;
+            if((size_t) available < chunk)
+            {
+                chunk = available;
+            }
+            //read the buffered bytes from the serial connection
+            count += Serial.readBytes(buffer + count, chunk);
         }
 
         return length;
@@ -92,6 +115,63 @@ public:
     {
         return Serial;
     }
+    /**
+     * function returning the baud rate the connection currently uses
+     * @return: the baud rate
+     */
+    long GetBaudRate()
+    {
+        return currentBaud;
+    }
+    /**
+     * function writing the baud rates the connection can switch to, see SERIAL_CONNECTION_BAUD_RATES
+     * @param rates: a buffer of the given size to store the rates
+     * @param maxCount: the size of the buffer
+     * @return: the number of rates written
+     */
+    int GetBaudRates(long* rates, int maxCount)
+    {
+        const long supported[] = SERIAL_CONNECTION_BAUD_RATES;
+        int count = 0;
+        for(long rate : supported)
+        {
+            if(count < maxCount)
+            {
+                rates[count++] = rate;
+            }
+        }
+        return count;
+    }
+    /**
+     * function switching to the given baud rate after the bytes already sent were transmitted
+     * Note: the next Connect() uses baud again
+     * @param _baud: the new baud rate
+     * @return: true
+     */
+    bool SetBaudRate(long _baud)
+    {
+        Serial.flush();
+        Serial.end();
+        Begin(_baud);
+        return true;
+    }
+
+private:
+    //the baud rate the serial port was started with
+    long currentBaud = 0;
+
+    /**
+     * function starting the serial port with the given baud rate
+     */
+    void Begin(long _baud)
+    {
+#if defined(ESP32) || defined(ESP8266) || defined(ALUP_HOST)
+        //has to be set before begin() on the ESP32
+        Serial.setRxBufferSize(SERIAL_CONNECTION_RX_BUFFER_SIZE);
+#endif
+        Serial.begin(_baud);
+        currentBaud = _baud;
+    }
 };
 
 #endif
@@ -0,0 +1,101 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+//independent of the Arduino core so that it can be used by host threads as well
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+//the alignment keeping the indices of both sides in separate cache lines
+#define SPSC_QUEUE_ALIGNMENT 64
+
+/**
+ * class implementing a lock-free queue of a fixed capacity between one producer and one consumer
+ * Each index is only written by one side: the producer publishes an item by storing tail (release) after
+ * writing the slot, the consumer frees a slot by storing head (release) after reading it. Items are copied
+ * into the ring, so large items like packets should be queued as pointers.
+ * Note: Push() may only be called by the producer, Front(), Pop() and Discard() only by the consumer
+ * @tparam T: the type of the items
+ * @tparam CAPACITY: the number of items the queue can hold; a power of 2
+ */
+template<class T, uint32_t CAPACITY>
+class SpscQueue
+{
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "the capacity has to be a power of 2");
+
+    public:
+        /**
+         * function adding an item to the end of the queue
+         * @param item: the item to add
+         * @return: false if the queue is full; the item is not added
+         */
+        bool Push(const T& item)
+        {
+            uint32_t tailIndex = tail.load(std::memory_order_relaxed);
+            if(tailIndex - head.load(std::memory_order_acquire) == CAPACITY)
+            {
+                return false;
+            }
+            items[tailIndex & (CAPACITY - 1)] = item;
+            tail.store(tailIndex + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * function returning the first item without removing it
+         * Note: the item stays valid until it is removed by Pop() or Discard()
+         * @return: the first item; nullptr if the queue is empty
+         */
+        T* Front()
+        {
+            uint32_t headIndex = head.load(std::memory_order_relaxed);
+            if(headIndex == tail.load(std::memory_order_acquire))
+            {
+                return nullptr;
+            }
+            return &items[headIndex & (CAPACITY - 1)];
+        }
+
+        /**
+         * function removing the first item
+         * @param item: the removed item
+         * @return: false if the queue is empty
+         */
+        bool Pop(T& item)
+        {
+            T* front = Front();
+            if(front == nullptr)
+            {
+                return false;
+            }
+            item = *front;
+            Discard();
+            return true;
+        }
+
+        /**
+         * function removing the first item returned by Front()
+         */
+        void Discard()
+        {
+            head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /**
+         * function returning the number of items in the queue
+         * Note: only exact for the calling side; the other side may change it at any time
+         */
+        uint32_t Count()
+        {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+    private:
+        //the index of the next item to remove, only written by the consumer
+        alignas(SPSC_QUEUE_ALIGNMENT) std::atomic<uint32_t> head {0};
+        //the index of the next item to add, only written by the producer
+        alignas(SPSC_QUEUE_ALIGNMENT) std::atomic<uint32_t> tail {0};
+        alignas(SPSC_QUEUE_ALIGNMENT) T items[CAPACITY];
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <Arduino.h>
+#include "Convert.h"
+
+//the number of buckets of a histogram; bucket n counts the durations below 4^(n + 2) microseconds,
+//i.e. 16us, 64us, ... 65ms, the last bucket all longer durations
+#define HISTOGRAM_BUCKETS 8
+//the size of a histogram in the answer to the STATISTICS command: the counts (32 bit each) and the total time (64 bit)
+#define HISTOGRAM_SIZE (4 * HISTOGRAM_BUCKETS + 8)
+//the size of the answer to the STATISTICS command following STATISTICS_BYTE:
+//the local time, 7 counters and 3 histograms
+#define STATISTICS_SIZE (4 * 8 + 3 * HISTOGRAM_SIZE)
+
+/**
+ * class counting durations in buckets of exponentially growing size
+ */
+class Histogram
+{
+    public:
+        uint32_t counts[HISTOGRAM_BUCKETS] = {0};
+        //the sum of all durations in microseconds; 64 bit so that it does not wrap after 71 minutes
+        uint64_t total = 0;
+
+        /**
+         * function adding the given duration
+         * Note: does nothing if ALUP_NO_STAGE_TIMING is defined
+         * @param duration: the duration in microseconds
+         */
+        void Add(unsigned long duration)
+        {
+#ifndef ALUP_NO_STAGE_TIMING
+            int bucket = 0;
+            for(unsigned long rest = duration >> 4; rest > 0 && bucket < HISTOGRAM_BUCKETS - 1; rest >>= 2)
+            {
+                bucket++;
+            }
+            counts[bucket]++;
+            total += duration;
+#endif
+        }
+
+        /**
+         * function writing the counts followed by the total time, high 32 bits first
+         * @param buffer: the buffer to write to; has to have a size of HISTOGRAM_SIZE
+         * @return: the number of bytes written
+         */
+        int Write(byte* buffer)
+        {
+            for(int i = 0; i < HISTOGRAM_BUCKETS; i++)
+            {
+                Convert::Int32ToBytes(counts[i], &buffer[4 * i]);
+            }
+            Convert::Int32ToBytes((uint32_t) (total >> 32), &buffer[4 * HISTOGRAM_BUCKETS]);
+            Convert::Int32ToBytes((uint32_t) total, &buffer[4 * HISTOGRAM_BUCKETS + 4]);
+            return HISTOGRAM_SIZE;
+        }
+};
+
+/**
+ * class collecting the counters and stage timings of a device since it was started
+ * Counters are never reset, so a master polling them calculates rates from the difference of two answers;
+ * they wrap around after 2^32.
+ * Frames are timed when their header starts and when they were read, encoded bodies once per Run() which
+ * receives a part of them, not per read or decoded chunk.
+ * Note: define ALUP_NO_STAGE_TIMING to leave out the micros() calls of the histograms
+ */
+class Statistics
+{
+    public:
+        //the frames applied and the frames answered with a frame error
+        uint32_t framesApplied = 0;
+        uint32_t frameErrors = 0;
+        //the bytes received and sent over the connection
+        uint32_t bytesReceived = 0;
+        uint32_t bytesSent = 0;
+        //the times the parser searched the next frame after the stream was corrupted
+        uint32_t resyncs = 0;
+        //the connections established with a master
+        uint32_t connections = 0;
+        //the calls showing the leds
+        uint32_t shows = 0;
+
+        //the time from the first header byte of each frame until its body was read and decoded
+        Histogram readTime;
+        //the time spent reading and decoding each encoded frame body from the received data
+        Histogram decodeTime;
+        //the time spent in each FastLED.show() or hand over to the render pipeline
+        Histogram showTime;
+
+        /**
+         * function returning the time used to measure a stage
+         * @return: micros(); 0 if ALUP_NO_STAGE_TIMING is defined
+         */
+        static unsigned long Now()
+        {
+#ifdef ALUP_NO_STAGE_TIMING
+            return 0;
+#else
+            return micros();
+#endif
+        }
+
+        /**
+         * function writing the answer to the STATISTICS command:
+         * local time, frames applied, frame errors, bytes received, bytes sent, resyncs, connections, shows,
+         * followed by the read, decode and show histograms (see Histogram::Write()), all big endian
+         * @param buffer: the buffer to write to; has to have a size of STATISTICS_SIZE
+         * @return: the number of bytes written
+         */
+        int Write(byte* buffer)
+        {
+            uint32_t counters[] = {(uint32_t) micros(), framesApplied, frameErrors, bytesReceived, bytesSent, resyncs, connections, shows};
+            int length = 0;
+            for(uint32_t counter : counters)
+            {
+                length += Convert::Int32ToBytes(counter, &buffer[length]);
+            }
+            length += readTime.Write(&buffer[length]);
+            length += decodeTime.Write(&buffer[length]);
+            length += showTime.Write(&buffer[length]);
+            return length;
+        }
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "UdpConnection.h"
+#include "Log.h"
 
 
 
@@ -11,10 +12,25 @@
  */
 UdpConnection::UdpConnection(char* _wifiSSID, char* _wifiPassword, char* _ip, int _port) : ip {_ip}, port {_port}, wifiSSID {_wifiSSID}, wifiPassword {_wifiPassword}
 {
+#if ALUP_LOG_LEVEL > ALUP_LOG_LEVEL_NONE
     if(!Serial)
     {
         Serial.begin(115200);
     }
+#endif
+}
+
+/**
+ * function setting a multicast group which is joined on Connect() in addition to receiving on receivingPort
+ * This lets one datagram sent by the master drive many devices, each applying its own slice of the
+ * frame, see ConfigurationOption::UNIVERSE. Answers are still sent to the remote ip and port.
+ * Note: broadcast datagrams sent to receivingPort are received without joining a group
+ * @param group: the multicast address, e.g. 239.1.2.3
+ */
+void UdpConnection::JoinMulticastGroup(IPAddress group)
+{
+    multicastGroup = group;
+    multicast = true;
 }
 
 /**
@@ -24,8 +40,17 @@ void UdpConnection::Connect()
 {
     //establish a wifi connection
     ConnectToWifi(wifiSSID, wifiPassword);
-    //start the UDP listener
-    udp.begin(receivingPort);
+    //start the UDP listener; unicast datagrams are received in both cases
+    if(multicast)
+    {
+        udp.beginMulticast(multicastGroup, receivingPort);
+    }
+    else
+    {
+        udp.begin(receivingPort);
+    }
+    //the connection request and the configuration are a plain byte stream
+    SetFragmentation(false);
     connected = true;
 }
 
@@ -37,21 +62,22 @@ void UdpConnection::Connect()
  */
 void UdpConnection::ConnectToWifi(char* _ssid, char* _password)
 {
+    //the WiFi may have reconnected on its own after it was lost
+    if(WiFi.status() == WL_CONNECTED)
+    {
+        return;
+    }
     //initialize the network connection
     WiFi.begin(_ssid, _password);
 
-    Serial.print("Connecting to wifi: ");
-    Serial.println(_ssid);
+    ALUP_LOG_INFO("Connecting to wifi: ", _ssid);
     
     //wait until the connection is established 
     while(WiFi.status() != WL_CONNECTED)
     {
-        Serial.print(".");
         delay(500);
     }
-    Serial.println("Connected.");
-    Serial.print("IP address: ");
-    Serial.println(WiFi.localIP());
+    ALUP_LOG_INFO("Connected. IP address: ", WiFi.localIP());
 }
 
 /**
@@ -62,7 +88,7 @@ void UdpConnection::Disconnect()
     udp.stop();
     WiFi.disconnect();
     connected = false;
-    Serial.println("Disconnected from WiFi.");
+    ALUP_LOG_INFO("Disconnected from WiFi.");
 }
 
 /**
@@ -74,16 +100,11 @@ void UdpConnection::Send(uint8_t* bytes, size_t lenght)
 {
     if(!WiFi.isConnected() || !isConnected())
     {
-        Serial.println("Could not send data: Not connected!");
+        ALUP_LOG_ERROR("Could not send data: Not connected!");
         return;
     }
-    Serial.println("Sending: ");
-    for(int i = 0; i < lenght; i ++)
-    {
-        Serial.print(bytes[i]);
-        Serial.print(" ");
-    }
-    Serial.println();
+    //logging every datagram would take longer than sending it, so it is only traced
+    ALUP_TRACE(TRACE_SEND, lenght);
     udp.beginPacket(ip, port);
     udp.write(bytes, lenght);
     udp.endPacket();
@@ -105,15 +126,38 @@ int UdpConnection::Read(uint8_t* buffer, size_t length)
 
     if(!WiFi.isConnected() || !isConnected())
     {
-        Serial.println("Could not receive data: Not connected!");
+        ALUP_LOG_ERROR("Could not receive data: Not connected!");
         return 0;
     }
 
-    while(udp.available() <= 0)
+    //datagrams end anywhere in the stream, so read until the given amount was received
+    size_t count = 0;
+    while(count < length && isConnected())
     {
-        udp.parsePacket();
+        if(fragmentation)
+        {
+            if(reassembler.Available() <= 0)
+            {
+                //the last frame was read completely
+                ReceiveFragments();
+                continue;
+            }
+            count += reassembler.Read(&buffer[count], length - count);
+            continue;
+        }
+        if(udp.available() <= 0)
+        {
+            udp.parsePacket();
+            continue;
+        }
+        int read = udp.read(&buffer[count], length - count);
+        if(read > 0)
+        {
+            count += read;
+        }
     }
-    return udp.read(buffer, length);
+    ALUP_TRACE(TRACE_RECEIVE, count);
+    return count;
 }
 
 /**
@@ -122,14 +166,71 @@ int UdpConnection::Read(uint8_t* buffer, size_t length)
  */
 int UdpConnection::Available()
 {
-    udp.parsePacket();
+    if(fragmentation)
+    {
+        //a frame being read is completed before newer ones are received
+        if(!reassembler.Reading())
+        {
+            ReceiveFragments();
+        }
+        return reassembler.Available();
+    }
+    if(udp.available() <= 0)
+    {
+        udp.parsePacket();
+    }
     return udp.available();
 }
+
+/**
+ * function adding all datagrams received so far to the reassembler, so that only the newest complete frame is read
+ * Note: the payload of each fragment is read directly into the frame it belongs to
+ */
+void UdpConnection::ReceiveFragments()
+{
+    //discard the rest of the last datagram, else no further datagram is parsed
+    udp.flush();
+    while(udp.parsePacket() > 0)
+    {
+        byte header[FRAGMENT_HEADER_SIZE];
+        int length = udp.available() - FRAGMENT_HEADER_SIZE;
+        if(length >= 0 && udp.read(header, FRAGMENT_HEADER_SIZE) == FRAGMENT_HEADER_SIZE)
+        {
+            byte* payload = reassembler.BeginFragment(header, length);
+            if(payload != nullptr && udp.read(payload, length) == length)
+            {
+                reassembler.EndFragment();
+            }
+        }
+        udp.flush();
+    }
+}
+
+/**
+ * function returning if frames can be received in fragments, see ConfigurationOption::FRAGMENTATION
+ * @return: always true
+ */
+bool UdpConnection::SupportsFragmentation()
+{
+    return true;
+}
+
+/**
+ * function switching between receiving a plain byte stream and frames reassembled from fragments
+ * Note: frames of an earlier connection are discarded
+ * @param enabled: true to receive reassembled frames
+ */
+void UdpConnection::SetFragmentation(bool enabled)
+{
+    fragmentation = enabled;
+    reassembler.Reset();
+}
 /**
  * function returning if the connection is established
+ * Note: false once the WiFi is lost, so that the device reconnects
  * @return: true if connected, else false
  */
 bool UdpConnection::isConnected()
 {
-    return connected;
+    return connected && WiFi.isConnected();
 }
\ No newline at end of file
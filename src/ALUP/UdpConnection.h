@@ -2,11 +2,12 @@
 #define UDP_CONNECTION_H
 
 #include "Connection.h"
+#include "FrameReassembler.h"
 #include <WiFi.h>
 #include <WiFiUdp.h>
 
 
-class UdpConnection : public Connection
+class UdpConnection final : public Connection
 {
     public:
         //ip and port of the remote socket
@@ -15,23 +16,34 @@ class UdpConnection : public Connection
         //the port of this device's udp socket where data is received
         int receivingPort = 5012;
         bool connected = false;
+        //the multicast group which is joined to receive frames sent to several devices, see JoinMulticastGroup()
+        IPAddress multicastGroup;
+        bool multicast = false;
 
         //the wifi udp socket
         WiFiUDP udp;
+        //reassembles the frames received in fragments, see ConfigurationOption::FRAGMENTATION
+        FrameReassembler reassembler;
+        //if datagrams carry fragments instead of a plain byte stream
+        bool fragmentation = false;
 
         UdpConnection(char* _wifiSSID, char* _wifiPassword, char* _ip, int _port);
+        void JoinMulticastGroup(IPAddress group);
         void Connect();
         void Disconnect();
         void Send(uint8_t* bytes, size_t size);
         int Read(uint8_t* buffer, size_t length);
         int Available();
         bool isConnected();
+        bool SupportsFragmentation();
+        void SetFragmentation(bool enabled);
         
     private:
         //the credentials for the wifi-network
         char* wifiSSID;
         char* wifiPassword;
         void ConnectToWifi(char* _ssid, char* _password);
+        void ReceiveFragments();
 
 };
 
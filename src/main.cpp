@@ -9,6 +9,8 @@
 #define NUM_LEDS 10
 #define DATA_PIN 13
 #define CLOCK_PIN 12
+//the max refresh rate of the leds in Hz; 0 to derive it from the led type
+#define MAX_REFRESH_RATE 0
 
 CRGB leds[NUM_LEDS];
 
@@ -21,6 +23,7 @@ void setup()
 {
     //initialize the LEDS
     FastLED.addLeds<WS2812B, DATA_PIN, GRB>(leds, NUM_LEDS);
+    alup.SetMaxRefreshRate(MAX_REFRESH_RATE);
     
 }
 void loop()
@@ -28,8 +31,7 @@ void loop()
     //try to connect if not connected
     if(!alup.connected)
     {
-      //try to connect/reconnect
-      delay(1000);
+      //try to connect/reconnect; the master may resume its session
       alup.Connect(&connection, "Test", "Extra values");
       
     }